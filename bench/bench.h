@@ -0,0 +1,141 @@
+#pragma once
+
+// Bits shared by the benchmarks, they include vkroots.h themselves first.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+  using Clock = std::chrono::steady_clock;
+
+  // How long each measurement runs, BENCH_MS in the environment overrides it.
+  static inline std::chrono::milliseconds Duration() {
+    const char* ms = std::getenv("BENCH_MS");
+    return std::chrono::milliseconds(ms && *ms ? std::atoi(ms) : 200);
+  }
+
+  // A fake handle, distinct and non-null for every index.
+  template <typename Handle>
+  static inline Handle MakeHandle(uint64_t index) {
+    return reinterpret_cast<Handle>(uintptr_t((index + 1) * 64u));
+  }
+
+  // Keeps the compiler from dropping a result.
+  template <typename T>
+  static inline void Use(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+  }
+
+  // Runs func(thread, stop) on count threads until Duration() is up,
+  // and returns the total of what they returned.
+  template <typename Func>
+  static inline uint64_t RunThreads(uint32_t count, Func func) {
+    std::atomic<bool> stop = false;
+    std::vector<uint64_t> results(count);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < count; i++)
+      threads.emplace_back([&, i] { results[i] = func(i, stop); });
+    std::this_thread::sleep_for(Duration());
+    stop.store(true, std::memory_order_relaxed);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      threads[i].join();
+      total += results[i];
+    }
+    return total;
+  }
+
+  static inline double NsPer(std::chrono::nanoseconds elapsed, uint64_t count) {
+    return count ? double(elapsed.count()) / double(count) : 0.0;
+  }
+
+}
+
+namespace bench::driver {
+
+  // Stands in for the loader and driver below the layer, so dispatch tables can be
+  // created without a GPU. Every function it hands out besides the few below does nothing.
+
+  // Dispatchable handles start with the loader's dispatch pointer, vkroots keys on it.
+  struct Object {
+    void* loaderData;
+  };
+
+  inline std::atomic<uint64_t> ProcAddrCalls = { 0u };
+
+  static inline VKAPI_ATTR void VKAPI_CALL NoOp() {
+  }
+
+  static inline VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* pProperties) {
+    *pProperties = VkPhysicalDeviceProperties{};
+    pProperties->apiVersion = VK_API_VERSION_1_4;
+  }
+
+  static inline VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice, const char* pName) {
+    ProcAddrCalls.fetch_add(1, std::memory_order_relaxed);
+    return pName ? reinterpret_cast<PFN_vkVoidFunction>(&NoOp) : nullptr;
+  }
+
+  static inline VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetInstanceProcAddr(VkInstance, const char* pName) {
+    ProcAddrCalls.fetch_add(1, std::memory_order_relaxed);
+    if (!std::strcmp(pName, "vkGetPhysicalDeviceProperties"))
+      return reinterpret_cast<PFN_vkVoidFunction>(&GetPhysicalDeviceProperties);
+    if (!std::strcmp(pName, "vkGetDeviceProcAddr"))
+      return reinterpret_cast<PFN_vkVoidFunction>(&GetDeviceProcAddr);
+    return reinterpret_cast<PFN_vkVoidFunction>(&NoOp);
+  }
+
+  static inline VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetPhysicalDeviceProcAddr(VkInstance instance, const char* pName) {
+    return GetInstanceProcAddr(instance, pName);
+  }
+
+  // An instance with one physical device, and devices created on it,
+  // each with their vkroots dispatch tables.
+  class Instance {
+  public:
+    Instance() {
+      VkInstanceCreateInfo createInfo = {};
+      createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+      vkroots::tables::CreateDispatchTable(&createInfo, &GetInstanceProcAddr, &GetPhysicalDeviceProcAddr, instance());
+      m_dispatch = vkroots::LookupDispatch(instance());
+      const VkPhysicalDevice physicalDevice = this->physicalDevice();
+      vkroots::tables::AssignDispatchTables(1, &physicalDevice, m_dispatch);
+    }
+
+    ~Instance() {
+      vkroots::tables::DestroyDispatchTable(instance());
+    }
+
+    Instance(const Instance&) = delete;
+
+    Instance& operator = (const Instance&) = delete;
+
+    VkInstance       instance()       { return reinterpret_cast<VkInstance>(&m_instance); }
+    VkPhysicalDevice physicalDevice() { return reinterpret_cast<VkPhysicalDevice>(&m_physicalDevice); }
+
+    VkDevice createDevice(Object& device) {
+      VkDeviceCreateInfo createInfo = {};
+      createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+      device.loaderData = &device;
+      vkroots::tables::CreateDispatchTable(&createInfo, &GetDeviceProcAddr, physicalDevice(), reinterpret_cast<VkDevice>(&device));
+      return reinterpret_cast<VkDevice>(&device);
+    }
+
+    void destroyDevice(VkDevice device) {
+      vkroots::tables::DestroyDispatchTable(device);
+    }
+
+  private:
+    Object                             m_instance       = { &m_instance };
+    Object                             m_physicalDevice = { &m_instance };
+    const vkroots::VkInstanceDispatch* m_dispatch       = nullptr;
+  };
+
+}
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Builds every benchmark next to its source, run them from here, eg. ./lookup
+# Pass extra flags in CXXFLAGS, eg. a Vulkan SDK include path.
+cd "$(dirname "$0")" || exit 1
+for source in *.cpp; do
+  g++ -std=c++20 -O2 -pthread -I.. $CXXFLAGS "$source" -o "${source%.cpp}" || exit 1
+done
+g++ -std=c++20 -O2 -pthread -I.. $CXXFLAGS -DVKROOTS_LAZY_NEXT_PROCS startup.cpp -o startup_lazy || exit 1
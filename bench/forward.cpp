@@ -0,0 +1,71 @@
+#include "vkroots.h"
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// An instance function called through a device's dispatch, the pointer chase
+// every layer's forwarded call pays. Once with everything in cache, and once
+// with the instance, physical device and device dispatches flushed before
+// every call, like the first call of a frame tends to find them.
+
+namespace {
+
+  template <typename T>
+  void Flush(const T* object) {
+#if defined(__x86_64__) || defined(__i386__)
+    const char* bytes = reinterpret_cast<const char*>(object);
+    for (size_t offset = 0; offset < sizeof(T); offset += 64)
+      _mm_clflush(bytes + offset);
+#else
+    (void)object;
+#endif
+  }
+
+}
+
+int main() {
+  bench::driver::Instance instance;
+  bench::driver::Object deviceObject;
+  const VkDevice device = instance.createDevice(deviceObject);
+  const VkPhysicalDevice physicalDevice = instance.physicalDevice();
+
+  const vkroots::VkInstanceDispatch*       instanceDispatch       = vkroots::LookupDispatch(instance.instance());
+  const vkroots::VkPhysicalDeviceDispatch* physicalDeviceDispatch = vkroots::LookupDispatch(physicalDevice);
+  const vkroots::VkDeviceDispatch*         deviceDispatch         = vkroots::LookupDispatch(device);
+
+  VkPhysicalDeviceFeatures features;
+
+  for (bool cold : { false, true }) {
+#if !defined(__x86_64__) && !defined(__i386__)
+    if (cold)
+      break;
+#endif
+    uint64_t calls = 0;
+    bench::Clock::duration elapsed = {};
+    const auto end = bench::Clock::now() + bench::Duration();
+    while (bench::Clock::now() < end) {
+      if (cold) {
+        Flush(instanceDispatch);
+        Flush(physicalDeviceDispatch);
+        Flush(deviceDispatch);
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_mfence();
+#endif
+      }
+
+      // Time a batch when warm, clock reads would dwarf a single call.
+      const uint32_t batch = cold ? 1 : 1024;
+      const auto start = bench::Clock::now();
+      for (uint32_t i = 0; i < batch; i++)
+        deviceDispatch->GetPhysicalDeviceFeatures(physicalDevice, &features);
+      elapsed += bench::Clock::now() - start;
+      calls += batch;
+    }
+
+    std::printf("GetPhysicalDeviceFeatures through VkDeviceDispatch, %-5s: %7.1f ns/call\n", cold ? "cold" : "warm", bench::NsPer(elapsed, calls));
+  }
+
+  instance.destroyDevice(device);
+}
@@ -0,0 +1,82 @@
+#include "vkroots.h"
+#include "bench.h"
+
+// Dispatch lookups from 1 to 64 threads, on their own and with another thread
+// allocating and freeing command buffers in the same map the whole time.
+
+namespace {
+
+  struct Object {
+    explicit Object(VkCommandBuffer cmdBuffer) : CmdBuffer(cmdBuffer) {}
+    VkCommandBuffer CmdBuffer;
+  };
+
+  constexpr uint32_t LiveObjects  = 1024;
+  constexpr uint32_t ChurnObjects = 64;
+
+  template <typename Map>
+  void Run(const char* name) {
+    for (bool churn : { false, true }) {
+      for (uint32_t threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u }) {
+        Map map;
+        for (uint32_t i = 0; i < LiveObjects; i++)
+          map.create(bench::MakeHandle<VkCommandBuffer>(i), bench::MakeHandle<VkCommandBuffer>(i));
+
+        std::atomic<bool> stopChurn = false;
+        uint64_t churned = 0;
+        std::thread churner;
+        if (churn) {
+          churner = std::thread([&] {
+            VkCommandBuffer cmdBuffers[ChurnObjects];
+            for (uint32_t i = 0; i < ChurnObjects; i++)
+              cmdBuffers[i] = bench::MakeHandle<VkCommandBuffer>(LiveObjects + i);
+            while (!stopChurn.load(std::memory_order_relaxed)) {
+              map.createMany(ChurnObjects, cmdBuffers);
+              map.eraseMany(ChurnObjects, cmdBuffers);
+              churned += ChurnObjects;
+            }
+          });
+        }
+
+        const auto start = bench::Clock::now();
+        const uint64_t lookups = bench::RunThreads(threads, [&](uint32_t thread, std::atomic<bool>& stop) {
+          uint64_t count = 0;
+          uint32_t index = thread * 7919u;
+          while (!stop.load(std::memory_order_relaxed)) {
+            for (uint32_t i = 0; i < 256; i++) {
+              index = (index + 613u) % LiveObjects;
+              const VkCommandBuffer cmdBuffer = bench::MakeHandle<VkCommandBuffer>(index);
+              const Object* object = map.find(cmdBuffer);
+              // Live objects are never touched by the churn, so every lookup has to find them.
+              if (!object || object->CmdBuffer != cmdBuffer) {
+                std::fprintf(stderr, "%s: lookup %u returned the wrong object\n", name, index);
+                std::abort();
+              }
+            }
+            count += 256;
+          }
+          return count;
+        });
+        const auto elapsed = bench::Clock::now() - start;
+
+        stopChurn.store(true, std::memory_order_relaxed);
+        if (churner.joinable())
+          churner.join();
+
+        std::printf("%-18s %-8s %2u threads: %8.1f Mlookups/s, %7.1f ns/lookup per thread", name, churn ? "churn" : "no churn",
+          threads, double(lookups) / std::chrono::duration<double, std::micro>(elapsed).count(),
+          bench::NsPer(elapsed * threads, lookups));
+        if (churn)
+          std::printf(", %.1f M objects churned/s", double(churned) / std::chrono::duration<double, std::micro>(elapsed).count());
+        std::printf("\n");
+      }
+    }
+  }
+
+}
+
+int main() {
+  Run<vkroots::ObjectMap<VkCommandBuffer, const Object>>("ObjectMap");
+  Run<vkroots::LockFreeObjectMap<VkCommandBuffer, const Object>>("LockFreeObjectMap");
+  Run<vkroots::EpochObjectMap<VkCommandBuffer, const Object>>("EpochObjectMap");
+}
@@ -0,0 +1,261 @@
+#include "vkroots.h"
+#include "bench.h"
+
+// Resolves every command name through the generated GetDeviceProcAddr and
+// GetInstanceProcAddr, like DXVK or Zink do for their whole function table
+// at device creation. Once for a layer overriding a couple of functions,
+// and once for one overriding every device function.
+
+namespace {
+
+  // An override that just calls the next layer, as a static member so that
+  // vkroots sees the layer overriding name.
+#define FORWARD(name) \
+  struct name##Forward { \
+    template <typename Dispatch, typename... Args> \
+    auto operator () (const Dispatch& dispatch, Args... args) const { return dispatch.name(args...); } \
+  }; \
+  static constexpr name##Forward name = {};
+
+  class SmallOverrides {
+  public:
+    FORWARD(CmdDraw) FORWARD(QueueSubmit)
+  };
+
+  class FullOverrides {
+  public:
+    FORWARD(AcquireNextImage2KHR) FORWARD(AcquireNextImageKHR) FORWARD(AcquirePerformanceConfigurationINTEL)
+    FORWARD(AcquireProfilingLockKHR) FORWARD(AllocateCommandBuffers) FORWARD(AllocateDescriptorSets)
+    FORWARD(AllocateMemory) FORWARD(AntiLagUpdateAMD) FORWARD(BeginCommandBuffer)
+    FORWARD(BindAccelerationStructureMemoryNV) FORWARD(BindBufferMemory) FORWARD(BindBufferMemory2)
+    FORWARD(BindBufferMemory2KHR) FORWARD(BindDataGraphPipelineSessionMemoryARM) FORWARD(BindImageMemory)
+    FORWARD(BindImageMemory2) FORWARD(BindImageMemory2KHR) FORWARD(BindOpticalFlowSessionImageNV)
+    FORWARD(BindTensorMemoryARM) FORWARD(BindVideoSessionMemoryKHR) FORWARD(BuildAccelerationStructuresKHR)
+    FORWARD(BuildMicromapsEXT) FORWARD(CmdBeginConditionalRenderingEXT) FORWARD(CmdBeginDebugUtilsLabelEXT)
+    FORWARD(CmdBeginPerTileExecutionQCOM) FORWARD(CmdBeginQuery) FORWARD(CmdBeginQueryIndexedEXT)
+    FORWARD(CmdBeginRenderPass) FORWARD(CmdBeginRenderPass2) FORWARD(CmdBeginRenderPass2KHR)
+    FORWARD(CmdBeginRendering) FORWARD(CmdBeginRenderingKHR) FORWARD(CmdBeginTransformFeedbackEXT)
+    FORWARD(CmdBeginVideoCodingKHR) FORWARD(CmdBindDescriptorBufferEmbeddedSamplers2EXT) FORWARD(CmdBindDescriptorBufferEmbeddedSamplersEXT)
+    FORWARD(CmdBindDescriptorBuffersEXT) FORWARD(CmdBindDescriptorSets) FORWARD(CmdBindDescriptorSets2KHR)
+    FORWARD(CmdBindIndexBuffer) FORWARD(CmdBindIndexBuffer2KHR) FORWARD(CmdBindInvocationMaskHUAWEI)
+    FORWARD(CmdBindPipeline) FORWARD(CmdBindPipelineShaderGroupNV) FORWARD(CmdBindShadersEXT)
+    FORWARD(CmdBindShadingRateImageNV) FORWARD(CmdBindTileMemoryQCOM) FORWARD(CmdBindTransformFeedbackBuffersEXT)
+    FORWARD(CmdBindVertexBuffers) FORWARD(CmdBindVertexBuffers2) FORWARD(CmdBindVertexBuffers2EXT)
+    FORWARD(CmdBlitImage) FORWARD(CmdBlitImage2) FORWARD(CmdBlitImage2KHR)
+    FORWARD(CmdBuildAccelerationStructureNV) FORWARD(CmdBuildAccelerationStructuresIndirectKHR) FORWARD(CmdBuildAccelerationStructuresKHR)
+    FORWARD(CmdBuildClusterAccelerationStructureIndirectNV) FORWARD(CmdBuildMicromapsEXT) FORWARD(CmdBuildPartitionedAccelerationStructuresNV)
+    FORWARD(CmdClearAttachments) FORWARD(CmdClearColorImage) FORWARD(CmdClearDepthStencilImage)
+    FORWARD(CmdControlVideoCodingKHR) FORWARD(CmdConvertCooperativeVectorMatrixNV) FORWARD(CmdCopyAccelerationStructureKHR)
+    FORWARD(CmdCopyAccelerationStructureNV) FORWARD(CmdCopyAccelerationStructureToMemoryKHR) FORWARD(CmdCopyBuffer)
+    FORWARD(CmdCopyBuffer2) FORWARD(CmdCopyBuffer2KHR) FORWARD(CmdCopyBufferToImage)
+    FORWARD(CmdCopyBufferToImage2) FORWARD(CmdCopyBufferToImage2KHR) FORWARD(CmdCopyImage)
+    FORWARD(CmdCopyImage2) FORWARD(CmdCopyImage2KHR) FORWARD(CmdCopyImageToBuffer)
+    FORWARD(CmdCopyImageToBuffer2) FORWARD(CmdCopyImageToBuffer2KHR) FORWARD(CmdCopyMemoryIndirectNV)
+    FORWARD(CmdCopyMemoryToAccelerationStructureKHR) FORWARD(CmdCopyMemoryToImageIndirectNV) FORWARD(CmdCopyMemoryToMicromapEXT)
+    FORWARD(CmdCopyMicromapEXT) FORWARD(CmdCopyMicromapToMemoryEXT) FORWARD(CmdCopyQueryPoolResults)
+    FORWARD(CmdCopyTensorARM) FORWARD(CmdDebugMarkerBeginEXT) FORWARD(CmdDebugMarkerEndEXT)
+    FORWARD(CmdDebugMarkerInsertEXT) FORWARD(CmdDecodeVideoKHR) FORWARD(CmdDecompressMemoryIndirectCountNV)
+    FORWARD(CmdDecompressMemoryNV) FORWARD(CmdDispatch) FORWARD(CmdDispatchBase)
+    FORWARD(CmdDispatchBaseKHR) FORWARD(CmdDispatchDataGraphARM) FORWARD(CmdDispatchIndirect)
+    FORWARD(CmdDispatchTileQCOM) FORWARD(CmdDraw) FORWARD(CmdDrawClusterHUAWEI)
+    FORWARD(CmdDrawClusterIndirectHUAWEI) FORWARD(CmdDrawIndexed) FORWARD(CmdDrawIndexedIndirect)
+    FORWARD(CmdDrawIndexedIndirectCount) FORWARD(CmdDrawIndexedIndirectCountAMD) FORWARD(CmdDrawIndexedIndirectCountKHR)
+    FORWARD(CmdDrawIndirect) FORWARD(CmdDrawIndirectByteCountEXT) FORWARD(CmdDrawIndirectCount)
+    FORWARD(CmdDrawIndirectCountAMD) FORWARD(CmdDrawIndirectCountKHR) FORWARD(CmdDrawMeshTasksEXT)
+    FORWARD(CmdDrawMeshTasksIndirectCountEXT) FORWARD(CmdDrawMeshTasksIndirectCountNV) FORWARD(CmdDrawMeshTasksIndirectEXT)
+    FORWARD(CmdDrawMeshTasksIndirectNV) FORWARD(CmdDrawMeshTasksNV) FORWARD(CmdDrawMultiEXT)
+    FORWARD(CmdDrawMultiIndexedEXT) FORWARD(CmdEncodeVideoKHR) FORWARD(CmdEndConditionalRenderingEXT)
+    FORWARD(CmdEndDebugUtilsLabelEXT) FORWARD(CmdEndPerTileExecutionQCOM) FORWARD(CmdEndQuery)
+    FORWARD(CmdEndQueryIndexedEXT) FORWARD(CmdEndRenderPass) FORWARD(CmdEndRenderPass2)
+    FORWARD(CmdEndRenderPass2KHR) FORWARD(CmdEndRendering) FORWARD(CmdEndRendering2EXT)
+    FORWARD(CmdEndRenderingKHR) FORWARD(CmdEndTransformFeedbackEXT) FORWARD(CmdEndVideoCodingKHR)
+    FORWARD(CmdExecuteCommands) FORWARD(CmdExecuteGeneratedCommandsEXT) FORWARD(CmdExecuteGeneratedCommandsNV)
+    FORWARD(CmdFillBuffer) FORWARD(CmdInsertDebugUtilsLabelEXT) FORWARD(CmdNextSubpass)
+    FORWARD(CmdNextSubpass2) FORWARD(CmdNextSubpass2KHR) FORWARD(CmdOpticalFlowExecuteNV)
+    FORWARD(CmdPipelineBarrier) FORWARD(CmdPipelineBarrier2) FORWARD(CmdPipelineBarrier2KHR)
+    FORWARD(CmdPreprocessGeneratedCommandsEXT) FORWARD(CmdPreprocessGeneratedCommandsNV) FORWARD(CmdPushConstants)
+    FORWARD(CmdPushConstants2KHR) FORWARD(CmdPushDescriptorSet2KHR) FORWARD(CmdPushDescriptorSetKHR)
+    FORWARD(CmdPushDescriptorSetWithTemplate2KHR) FORWARD(CmdPushDescriptorSetWithTemplateKHR) FORWARD(CmdResetEvent)
+    FORWARD(CmdResetEvent2) FORWARD(CmdResetEvent2KHR) FORWARD(CmdResetQueryPool)
+    FORWARD(CmdResolveImage) FORWARD(CmdResolveImage2) FORWARD(CmdResolveImage2KHR)
+    FORWARD(CmdSetAlphaToCoverageEnableEXT) FORWARD(CmdSetAlphaToOneEnableEXT) FORWARD(CmdSetAttachmentFeedbackLoopEnableEXT)
+    FORWARD(CmdSetBlendConstants) FORWARD(CmdSetCheckpointNV) FORWARD(CmdSetCoarseSampleOrderNV)
+    FORWARD(CmdSetColorBlendAdvancedEXT) FORWARD(CmdSetColorBlendEnableEXT) FORWARD(CmdSetColorBlendEquationEXT)
+    FORWARD(CmdSetColorWriteEnableEXT) FORWARD(CmdSetColorWriteMaskEXT) FORWARD(CmdSetConservativeRasterizationModeEXT)
+    FORWARD(CmdSetCoverageModulationModeNV) FORWARD(CmdSetCoverageModulationTableEnableNV) FORWARD(CmdSetCoverageModulationTableNV)
+    FORWARD(CmdSetCoverageReductionModeNV) FORWARD(CmdSetCoverageToColorEnableNV) FORWARD(CmdSetCoverageToColorLocationNV)
+    FORWARD(CmdSetCullMode) FORWARD(CmdSetCullModeEXT) FORWARD(CmdSetDepthBias)
+    FORWARD(CmdSetDepthBias2EXT) FORWARD(CmdSetDepthBiasEnable) FORWARD(CmdSetDepthBiasEnableEXT)
+    FORWARD(CmdSetDepthBounds) FORWARD(CmdSetDepthBoundsTestEnable) FORWARD(CmdSetDepthBoundsTestEnableEXT)
+    FORWARD(CmdSetDepthClampEnableEXT) FORWARD(CmdSetDepthClampRangeEXT) FORWARD(CmdSetDepthClipEnableEXT)
+    FORWARD(CmdSetDepthClipNegativeOneToOneEXT) FORWARD(CmdSetDepthCompareOp) FORWARD(CmdSetDepthCompareOpEXT)
+    FORWARD(CmdSetDepthTestEnable) FORWARD(CmdSetDepthTestEnableEXT) FORWARD(CmdSetDepthWriteEnable)
+    FORWARD(CmdSetDepthWriteEnableEXT) FORWARD(CmdSetDescriptorBufferOffsets2EXT) FORWARD(CmdSetDescriptorBufferOffsetsEXT)
+    FORWARD(CmdSetDeviceMask) FORWARD(CmdSetDeviceMaskKHR) FORWARD(CmdSetDiscardRectangleEXT)
+    FORWARD(CmdSetDiscardRectangleEnableEXT) FORWARD(CmdSetDiscardRectangleModeEXT) FORWARD(CmdSetEvent)
+    FORWARD(CmdSetEvent2) FORWARD(CmdSetEvent2KHR) FORWARD(CmdSetExclusiveScissorEnableNV)
+    FORWARD(CmdSetExclusiveScissorNV) FORWARD(CmdSetExtraPrimitiveOverestimationSizeEXT) FORWARD(CmdSetFragmentShadingRateEnumNV)
+    FORWARD(CmdSetFragmentShadingRateKHR) FORWARD(CmdSetFrontFace) FORWARD(CmdSetFrontFaceEXT)
+    FORWARD(CmdSetLineRasterizationModeEXT) FORWARD(CmdSetLineStippleEXT) FORWARD(CmdSetLineStippleEnableEXT)
+    FORWARD(CmdSetLineStippleKHR) FORWARD(CmdSetLineWidth) FORWARD(CmdSetLogicOpEXT)
+    FORWARD(CmdSetLogicOpEnableEXT) FORWARD(CmdSetPatchControlPointsEXT) FORWARD(CmdSetPerformanceMarkerINTEL)
+    FORWARD(CmdSetPerformanceOverrideINTEL) FORWARD(CmdSetPerformanceStreamMarkerINTEL) FORWARD(CmdSetPolygonModeEXT)
+    FORWARD(CmdSetPrimitiveRestartEnable) FORWARD(CmdSetPrimitiveRestartEnableEXT) FORWARD(CmdSetPrimitiveTopology)
+    FORWARD(CmdSetPrimitiveTopologyEXT) FORWARD(CmdSetProvokingVertexModeEXT) FORWARD(CmdSetRasterizationSamplesEXT)
+    FORWARD(CmdSetRasterizationStreamEXT) FORWARD(CmdSetRasterizerDiscardEnable) FORWARD(CmdSetRasterizerDiscardEnableEXT)
+    FORWARD(CmdSetRayTracingPipelineStackSizeKHR) FORWARD(CmdSetRenderingAttachmentLocationsKHR) FORWARD(CmdSetRenderingInputAttachmentIndicesKHR)
+    FORWARD(CmdSetRepresentativeFragmentTestEnableNV) FORWARD(CmdSetSampleLocationsEXT) FORWARD(CmdSetSampleLocationsEnableEXT)
+    FORWARD(CmdSetSampleMaskEXT) FORWARD(CmdSetScissor) FORWARD(CmdSetScissorWithCount)
+    FORWARD(CmdSetScissorWithCountEXT) FORWARD(CmdSetShadingRateImageEnableNV) FORWARD(CmdSetStencilCompareMask)
+    FORWARD(CmdSetStencilOp) FORWARD(CmdSetStencilOpEXT) FORWARD(CmdSetStencilReference)
+    FORWARD(CmdSetStencilTestEnable) FORWARD(CmdSetStencilTestEnableEXT) FORWARD(CmdSetStencilWriteMask)
+    FORWARD(CmdSetTessellationDomainOriginEXT) FORWARD(CmdSetVertexInputEXT) FORWARD(CmdSetViewport)
+    FORWARD(CmdSetViewportShadingRatePaletteNV) FORWARD(CmdSetViewportSwizzleNV) FORWARD(CmdSetViewportWScalingEnableNV)
+    FORWARD(CmdSetViewportWScalingNV) FORWARD(CmdSetViewportWithCount) FORWARD(CmdSetViewportWithCountEXT)
+    FORWARD(CmdSubpassShadingHUAWEI) FORWARD(CmdTraceRaysIndirect2KHR) FORWARD(CmdTraceRaysIndirectKHR)
+    FORWARD(CmdTraceRaysKHR) FORWARD(CmdTraceRaysNV) FORWARD(CmdUpdateBuffer)
+    FORWARD(CmdUpdatePipelineIndirectBufferNV) FORWARD(CmdWaitEvents) FORWARD(CmdWaitEvents2)
+    FORWARD(CmdWaitEvents2KHR) FORWARD(CmdWriteAccelerationStructuresPropertiesKHR) FORWARD(CmdWriteAccelerationStructuresPropertiesNV)
+    FORWARD(CmdWriteBufferMarker2AMD) FORWARD(CmdWriteBufferMarkerAMD) FORWARD(CmdWriteMicromapsPropertiesEXT)
+    FORWARD(CmdWriteTimestamp) FORWARD(CmdWriteTimestamp2) FORWARD(CmdWriteTimestamp2KHR)
+    FORWARD(CompileDeferredNV) FORWARD(ConvertCooperativeVectorMatrixNV) FORWARD(CopyAccelerationStructureKHR)
+    FORWARD(CopyAccelerationStructureToMemoryKHR) FORWARD(CopyImageToImageEXT) FORWARD(CopyImageToMemoryEXT)
+    FORWARD(CopyMemoryToAccelerationStructureKHR) FORWARD(CopyMemoryToImageEXT) FORWARD(CopyMemoryToMicromapEXT)
+    FORWARD(CopyMicromapEXT) FORWARD(CopyMicromapToMemoryEXT) FORWARD(CreateAccelerationStructureKHR)
+    FORWARD(CreateAccelerationStructureNV) FORWARD(CreateBuffer) FORWARD(CreateBufferView)
+    FORWARD(CreateCommandPool) FORWARD(CreateComputePipelines) FORWARD(CreateDataGraphPipelineSessionARM)
+    FORWARD(CreateDataGraphPipelinesARM) FORWARD(CreateDeferredOperationKHR) FORWARD(CreateDescriptorPool)
+    FORWARD(CreateDescriptorSetLayout) FORWARD(CreateDescriptorUpdateTemplate) FORWARD(CreateDescriptorUpdateTemplateKHR)
+    FORWARD(CreateEvent) FORWARD(CreateExternalComputeQueueNV) FORWARD(CreateFence)
+    FORWARD(CreateFramebuffer) FORWARD(CreateGraphicsPipelines) FORWARD(CreateImage)
+    FORWARD(CreateImageView) FORWARD(CreateIndirectCommandsLayoutEXT) FORWARD(CreateIndirectCommandsLayoutNV)
+    FORWARD(CreateIndirectExecutionSetEXT) FORWARD(CreateMicromapEXT) FORWARD(CreateOpticalFlowSessionNV)
+    FORWARD(CreatePipelineBinariesKHR) FORWARD(CreatePipelineCache) FORWARD(CreatePipelineLayout)
+    FORWARD(CreatePrivateDataSlot) FORWARD(CreatePrivateDataSlotEXT) FORWARD(CreateQueryPool)
+    FORWARD(CreateRayTracingPipelinesKHR) FORWARD(CreateRayTracingPipelinesNV) FORWARD(CreateRenderPass)
+    FORWARD(CreateRenderPass2) FORWARD(CreateRenderPass2KHR) FORWARD(CreateSampler)
+    FORWARD(CreateSamplerYcbcrConversion) FORWARD(CreateSamplerYcbcrConversionKHR) FORWARD(CreateSemaphore)
+    FORWARD(CreateShaderModule) FORWARD(CreateShadersEXT) FORWARD(CreateSharedSwapchainsKHR)
+    FORWARD(CreateSwapchainKHR) FORWARD(CreateTensorARM) FORWARD(CreateTensorViewARM)
+    FORWARD(CreateValidationCacheEXT) FORWARD(CreateVideoSessionKHR) FORWARD(CreateVideoSessionParametersKHR)
+    FORWARD(DebugMarkerSetObjectNameEXT) FORWARD(DebugMarkerSetObjectTagEXT) FORWARD(DeferredOperationJoinKHR)
+    FORWARD(DestroyAccelerationStructureKHR) FORWARD(DestroyAccelerationStructureNV) FORWARD(DestroyBuffer)
+    FORWARD(DestroyBufferView) FORWARD(DestroyCommandPool) FORWARD(DestroyDataGraphPipelineSessionARM)
+    FORWARD(DestroyDeferredOperationKHR) FORWARD(DestroyDescriptorPool) FORWARD(DestroyDescriptorSetLayout)
+    FORWARD(DestroyDescriptorUpdateTemplate) FORWARD(DestroyDescriptorUpdateTemplateKHR) FORWARD(DestroyDevice)
+    FORWARD(DestroyEvent) FORWARD(DestroyExternalComputeQueueNV) FORWARD(DestroyFence)
+    FORWARD(DestroyFramebuffer) FORWARD(DestroyImage) FORWARD(DestroyImageView)
+    FORWARD(DestroyIndirectCommandsLayoutEXT) FORWARD(DestroyIndirectCommandsLayoutNV) FORWARD(DestroyIndirectExecutionSetEXT)
+    FORWARD(DestroyMicromapEXT) FORWARD(DestroyOpticalFlowSessionNV) FORWARD(DestroyPipeline)
+    FORWARD(DestroyPipelineBinaryKHR) FORWARD(DestroyPipelineCache) FORWARD(DestroyPipelineLayout)
+    FORWARD(DestroyPrivateDataSlot) FORWARD(DestroyPrivateDataSlotEXT) FORWARD(DestroyQueryPool)
+    FORWARD(DestroyRenderPass) FORWARD(DestroySampler) FORWARD(DestroySamplerYcbcrConversion)
+    FORWARD(DestroySamplerYcbcrConversionKHR) FORWARD(DestroySemaphore) FORWARD(DestroyShaderEXT)
+    FORWARD(DestroyShaderModule) FORWARD(DestroySwapchainKHR) FORWARD(DestroyTensorARM)
+    FORWARD(DestroyTensorViewARM) FORWARD(DestroyValidationCacheEXT) FORWARD(DestroyVideoSessionKHR)
+    FORWARD(DestroyVideoSessionParametersKHR) FORWARD(DeviceWaitIdle) FORWARD(DisplayPowerControlEXT)
+    FORWARD(EndCommandBuffer) FORWARD(FlushMappedMemoryRanges) FORWARD(FreeCommandBuffers)
+    FORWARD(FreeDescriptorSets) FORWARD(FreeMemory) FORWARD(GetAccelerationStructureBuildSizesKHR)
+    FORWARD(GetAccelerationStructureDeviceAddressKHR) FORWARD(GetAccelerationStructureHandleNV) FORWARD(GetAccelerationStructureMemoryRequirementsNV)
+    FORWARD(GetAccelerationStructureOpaqueCaptureDescriptorDataEXT) FORWARD(GetBufferDeviceAddress) FORWARD(GetBufferDeviceAddressEXT)
+    FORWARD(GetBufferDeviceAddressKHR) FORWARD(GetBufferMemoryRequirements) FORWARD(GetBufferMemoryRequirements2)
+    FORWARD(GetBufferMemoryRequirements2KHR) FORWARD(GetBufferOpaqueCaptureAddress) FORWARD(GetBufferOpaqueCaptureAddressKHR)
+    FORWARD(GetBufferOpaqueCaptureDescriptorDataEXT) FORWARD(GetCalibratedTimestampsEXT) FORWARD(GetCalibratedTimestampsKHR)
+    FORWARD(GetClusterAccelerationStructureBuildSizesNV) FORWARD(GetDataGraphPipelineAvailablePropertiesARM) FORWARD(GetDataGraphPipelinePropertiesARM)
+    FORWARD(GetDataGraphPipelineSessionBindPointRequirementsARM) FORWARD(GetDataGraphPipelineSessionMemoryRequirementsARM) FORWARD(GetDeferredOperationMaxConcurrencyKHR)
+    FORWARD(GetDeferredOperationResultKHR) FORWARD(GetDescriptorEXT) FORWARD(GetDescriptorSetHostMappingVALVE)
+    FORWARD(GetDescriptorSetLayoutBindingOffsetEXT) FORWARD(GetDescriptorSetLayoutHostMappingInfoVALVE) FORWARD(GetDescriptorSetLayoutSizeEXT)
+    FORWARD(GetDescriptorSetLayoutSupport) FORWARD(GetDescriptorSetLayoutSupportKHR) FORWARD(GetDeviceAccelerationStructureCompatibilityKHR)
+    FORWARD(GetDeviceBufferMemoryRequirements) FORWARD(GetDeviceBufferMemoryRequirementsKHR) FORWARD(GetDeviceFaultInfoEXT)
+    FORWARD(GetDeviceGroupPeerMemoryFeatures) FORWARD(GetDeviceGroupPeerMemoryFeaturesKHR) FORWARD(GetDeviceGroupPresentCapabilitiesKHR)
+    FORWARD(GetDeviceGroupSurfacePresentModesKHR) FORWARD(GetDeviceImageMemoryRequirements) FORWARD(GetDeviceImageMemoryRequirementsKHR)
+    FORWARD(GetDeviceImageSparseMemoryRequirements) FORWARD(GetDeviceImageSparseMemoryRequirementsKHR) FORWARD(GetDeviceImageSubresourceLayoutKHR)
+    FORWARD(GetDeviceMemoryCommitment) FORWARD(GetDeviceMemoryOpaqueCaptureAddress) FORWARD(GetDeviceMemoryOpaqueCaptureAddressKHR)
+    FORWARD(GetDeviceMicromapCompatibilityEXT) FORWARD(GetDeviceQueue) FORWARD(GetDeviceQueue2)
+    FORWARD(GetDeviceSubpassShadingMaxWorkgroupSizeHUAWEI) FORWARD(GetDeviceTensorMemoryRequirementsARM) FORWARD(GetDynamicRenderingTilePropertiesQCOM)
+    FORWARD(GetEncodedVideoSessionParametersKHR) FORWARD(GetEventStatus) FORWARD(GetFenceFdKHR)
+    FORWARD(GetFenceStatus) FORWARD(GetFramebufferTilePropertiesQCOM) FORWARD(GetGeneratedCommandsMemoryRequirementsEXT)
+    FORWARD(GetGeneratedCommandsMemoryRequirementsNV) FORWARD(GetImageDrmFormatModifierPropertiesEXT) FORWARD(GetImageMemoryRequirements)
+    FORWARD(GetImageMemoryRequirements2) FORWARD(GetImageMemoryRequirements2KHR) FORWARD(GetImageOpaqueCaptureDescriptorDataEXT)
+    FORWARD(GetImageSparseMemoryRequirements) FORWARD(GetImageSparseMemoryRequirements2) FORWARD(GetImageSparseMemoryRequirements2KHR)
+    FORWARD(GetImageSubresourceLayout) FORWARD(GetImageSubresourceLayout2EXT) FORWARD(GetImageSubresourceLayout2KHR)
+    FORWARD(GetImageViewOpaqueCaptureDescriptorDataEXT) FORWARD(GetLatencyTimingsNV) FORWARD(GetMemoryFdKHR)
+    FORWARD(GetMemoryFdPropertiesKHR) FORWARD(GetMemoryHostPointerPropertiesEXT) FORWARD(GetMemoryRemoteAddressNV)
+    FORWARD(GetMicromapBuildSizesEXT) FORWARD(GetPartitionedAccelerationStructuresBuildSizesNV) FORWARD(GetPastPresentationTimingGOOGLE)
+    FORWARD(GetPerformanceParameterINTEL) FORWARD(GetPipelineBinaryDataKHR) FORWARD(GetPipelineCacheData)
+    FORWARD(GetPipelineExecutableInternalRepresentationsKHR) FORWARD(GetPipelineExecutablePropertiesKHR) FORWARD(GetPipelineExecutableStatisticsKHR)
+    FORWARD(GetPipelineIndirectDeviceAddressNV) FORWARD(GetPipelineIndirectMemoryRequirementsNV) FORWARD(GetPipelineKeyKHR)
+    FORWARD(GetPipelinePropertiesEXT) FORWARD(GetPrivateData) FORWARD(GetPrivateDataEXT)
+    FORWARD(GetQueryPoolResults) FORWARD(GetQueueCheckpointData2NV) FORWARD(GetQueueCheckpointDataNV)
+    FORWARD(GetRayTracingCaptureReplayShaderGroupHandlesKHR) FORWARD(GetRayTracingShaderGroupHandlesKHR) FORWARD(GetRayTracingShaderGroupHandlesNV)
+    FORWARD(GetRayTracingShaderGroupStackSizeKHR) FORWARD(GetRefreshCycleDurationGOOGLE) FORWARD(GetRenderAreaGranularity)
+    FORWARD(GetRenderingAreaGranularityKHR) FORWARD(GetSamplerOpaqueCaptureDescriptorDataEXT) FORWARD(GetSemaphoreCounterValue)
+    FORWARD(GetSemaphoreCounterValueKHR) FORWARD(GetSemaphoreFdKHR) FORWARD(GetShaderBinaryDataEXT)
+    FORWARD(GetShaderInfoAMD) FORWARD(GetShaderModuleCreateInfoIdentifierEXT) FORWARD(GetShaderModuleIdentifierEXT)
+    FORWARD(GetSwapchainCounterEXT) FORWARD(GetSwapchainImagesKHR) FORWARD(GetSwapchainStatusKHR)
+    FORWARD(GetTensorMemoryRequirementsARM) FORWARD(GetTensorOpaqueCaptureDescriptorDataARM) FORWARD(GetTensorViewOpaqueCaptureDescriptorDataARM)
+    FORWARD(GetValidationCacheDataEXT) FORWARD(GetVideoSessionMemoryRequirementsKHR) FORWARD(ImportFenceFdKHR)
+    FORWARD(ImportSemaphoreFdKHR) FORWARD(InitializePerformanceApiINTEL) FORWARD(InvalidateMappedMemoryRanges)
+    FORWARD(LatencySleepNV) FORWARD(MapMemory) FORWARD(MapMemory2KHR)
+    FORWARD(MergePipelineCaches) FORWARD(MergeValidationCachesEXT) FORWARD(QueueBeginDebugUtilsLabelEXT)
+    FORWARD(QueueBindSparse) FORWARD(QueueEndDebugUtilsLabelEXT) FORWARD(QueueInsertDebugUtilsLabelEXT)
+    FORWARD(QueueNotifyOutOfBandNV) FORWARD(QueuePresentKHR) FORWARD(QueueSetPerformanceConfigurationINTEL)
+    FORWARD(QueueSubmit) FORWARD(QueueSubmit2) FORWARD(QueueSubmit2KHR)
+    FORWARD(QueueWaitIdle) FORWARD(RegisterDeviceEventEXT) FORWARD(RegisterDisplayEventEXT)
+    FORWARD(ReleaseCapturedPipelineDataKHR) FORWARD(ReleasePerformanceConfigurationINTEL) FORWARD(ReleaseProfilingLockKHR)
+    FORWARD(ReleaseSwapchainImagesEXT) FORWARD(ReleaseSwapchainImagesKHR) FORWARD(ResetCommandBuffer)
+    FORWARD(ResetCommandPool) FORWARD(ResetDescriptorPool) FORWARD(ResetEvent)
+    FORWARD(ResetFences) FORWARD(ResetQueryPool) FORWARD(ResetQueryPoolEXT)
+    FORWARD(SetDebugUtilsObjectNameEXT) FORWARD(SetDebugUtilsObjectTagEXT) FORWARD(SetDeviceMemoryPriorityEXT)
+    FORWARD(SetEvent) FORWARD(SetHdrMetadataEXT) FORWARD(SetLatencyMarkerNV)
+    FORWARD(SetLatencySleepModeNV) FORWARD(SetLocalDimmingAMD) FORWARD(SetPrivateData)
+    FORWARD(SetPrivateDataEXT) FORWARD(SignalSemaphore) FORWARD(SignalSemaphoreKHR)
+    FORWARD(TransitionImageLayoutEXT) FORWARD(TrimCommandPool) FORWARD(TrimCommandPoolKHR)
+    FORWARD(UninitializePerformanceApiINTEL) FORWARD(UnmapMemory) FORWARD(UnmapMemory2KHR)
+    FORWARD(UpdateDescriptorSetWithTemplate) FORWARD(UpdateDescriptorSetWithTemplateKHR) FORWARD(UpdateDescriptorSets)
+    FORWARD(UpdateIndirectExecutionSetPipelineEXT) FORWARD(UpdateIndirectExecutionSetShaderEXT) FORWARD(UpdateVideoSessionParametersKHR)
+    FORWARD(WaitForFences) FORWARD(WaitForPresent2KHR) FORWARD(WaitForPresentKHR)
+    FORWARD(WaitSemaphores) FORWARD(WaitSemaphoresKHR) FORWARD(WriteAccelerationStructuresPropertiesKHR)
+    FORWARD(WriteMicromapsPropertiesEXT)
+  };
+
+#undef FORWARD
+
+  template <typename DeviceOverrides>
+  void Run(const char* name, bench::driver::Instance& instance, VkDevice device) {
+    constexpr uint32_t Count = uint32_t(vkroots::Function::Count);
+
+    for (bool deviceLevel : { true, false }) {
+      uint64_t lookups = 0;
+      uint64_t found = 0;
+      const auto start = bench::Clock::now();
+      const auto end = start + bench::Duration();
+      while (bench::Clock::now() < end) {
+        for (uint32_t i = 0; i < Count; i++) {
+          const PFN_vkVoidFunction function = deviceLevel
+            ? vkroots::GetDeviceProcAddr<vkroots::NoOverrides, DeviceOverrides>(device, vkroots::FunctionNames[i])
+            : vkroots::GetInstanceProcAddr<vkroots::NoOverrides, DeviceOverrides>(instance.instance(), vkroots::FunctionNames[i]);
+          found += function != nullptr;
+        }
+        lookups += Count;
+      }
+      const auto elapsed = bench::Clock::now() - start;
+
+      std::printf("%-7s %-19s %u names: %6.1f ns/lookup, %llu of %llu resolved\n", name,
+        deviceLevel ? "GetDeviceProcAddr" : "GetInstanceProcAddr", Count,
+        bench::NsPer(elapsed, lookups), (unsigned long long)(found / (lookups / Count)), (unsigned long long)Count);
+    }
+  }
+
+}
+
+int main() {
+  bench::driver::Instance instance;
+  bench::driver::Object deviceObject;
+  const VkDevice device = instance.createDevice(deviceObject);
+
+  Run<SmallOverrides>("small", instance, device);
+  Run<FullOverrides>("full", instance, device);
+
+  instance.destroyDevice(device);
+}
@@ -0,0 +1,69 @@
+#include "vkroots.h"
+#include "bench.h"
+
+#include <shared_mutex>
+
+// Read locking RwLock, BravoRwLock and std::shared_mutex from 1 to 64 threads,
+// on their own and with a writer taking the lock every 100us, like a layer
+// creating the odd object while every other thread only looks them up.
+
+namespace {
+
+  template <typename Lock>
+  void Run(const char* name) {
+    for (bool writer : { false, true }) {
+      for (uint32_t threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u }) {
+        Lock lock;
+        uint64_t shared = 0;
+
+        std::atomic<bool> stopWriter = false;
+        uint64_t writes = 0;
+        std::thread writerThread;
+        if (writer) {
+          writerThread = std::thread([&] {
+            while (!stopWriter.load(std::memory_order_relaxed)) {
+              {
+                std::unique_lock guard(lock);
+                shared++;
+                writes++;
+              }
+              std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+          });
+        }
+
+        const auto start = bench::Clock::now();
+        const uint64_t reads = bench::RunThreads(threads, [&](uint32_t, std::atomic<bool>& stop) {
+          uint64_t count = 0;
+          while (!stop.load(std::memory_order_relaxed)) {
+            for (uint32_t i = 0; i < 256; i++) {
+              std::shared_lock guard(lock);
+              bench::Use(shared);
+            }
+            count += 256;
+          }
+          return count;
+        });
+        const auto elapsed = bench::Clock::now() - start;
+
+        stopWriter.store(true, std::memory_order_relaxed);
+        if (writerThread.joinable())
+          writerThread.join();
+
+        std::printf("%-18s %-9s %2u threads: %8.1f Mlocks/s, %7.1f ns/lock per thread", name, writer ? "writer" : "no writer",
+          threads, double(reads) / std::chrono::duration<double, std::micro>(elapsed).count(),
+          bench::NsPer(elapsed * threads, reads));
+        if (writer)
+          std::printf(", %.1f k writes/s", double(writes) / std::chrono::duration<double, std::milli>(elapsed).count());
+        std::printf("\n");
+      }
+    }
+  }
+
+}
+
+int main() {
+  Run<vkroots::RwLock>("RwLock");
+  Run<vkroots::BravoRwLock>("BravoRwLock");
+  Run<std::shared_mutex>("std::shared_mutex");
+}
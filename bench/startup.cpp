@@ -0,0 +1,48 @@
+#include "vkroots.h"
+#include "bench.h"
+
+// Creating and destroying a device's dispatch table, the part of vkCreateDevice
+// vkroots adds on top of the driver. build.sh and meson also build this with
+// VKROOTS_LAZY_NEXT_PROCS as startup_lazy.
+//
+// The fake driver's vkGetDeviceProcAddr costs next to nothing, a real loader
+// looks the name up, so the number of calls matters as much as the time.
+
+int main() {
+#ifdef VKROOTS_LAZY_NEXT_PROCS
+  const char* mode = "lazy";
+#else
+  const char* mode = "eager";
+#endif
+
+  bench::driver::Instance instance;
+  bench::driver::Object deviceObject;
+
+  uint64_t devices = 0;
+  const uint64_t callsBefore = bench::driver::ProcAddrCalls.load(std::memory_order_relaxed);
+  const auto start = bench::Clock::now();
+  const auto end = start + bench::Duration();
+  while (bench::Clock::now() < end) {
+    instance.destroyDevice(instance.createDevice(deviceObject));
+    devices++;
+  }
+  const auto elapsed = bench::Clock::now() - start;
+  const uint64_t calls = bench::driver::ProcAddrCalls.load(std::memory_order_relaxed) - callsBefore;
+
+  std::printf("%-5s create + destroy device: %8.1f us, %5llu next GetProcAddr calls\n", mode,
+    bench::NsPer(elapsed, devices) / 1000.0, (unsigned long long)(calls / devices));
+
+  // What the lazy mode pays back later, the first call of each function.
+  const VkDevice device = instance.createDevice(deviceObject);
+  const vkroots::VkDeviceDispatch* dispatch = vkroots::LookupDispatch(device);
+  const auto firstStart = bench::Clock::now();
+  dispatch->CmdDraw(VK_NULL_HANDLE, 3, 1, 0, 0);
+  const auto firstElapsed = bench::Clock::now() - firstStart;
+  const auto secondStart = bench::Clock::now();
+  dispatch->CmdDraw(VK_NULL_HANDLE, 3, 1, 0, 0);
+  const auto secondElapsed = bench::Clock::now() - secondStart;
+  instance.destroyDevice(device);
+
+  std::printf("%-5s first CmdDraw %lld ns, second %lld ns\n", mode,
+    (long long)std::chrono::nanoseconds(firstElapsed).count(), (long long)std::chrono::nanoseconds(secondElapsed).count());
+}
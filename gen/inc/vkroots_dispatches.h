@@ -1,79 +1,129 @@
-namespace vkroots::tables {
+namespace vkroots {
 
-  static inline void CreateDispatchTable(PFN_vkGetInstanceProcAddr nextInstanceProcAddr, PFN_GetPhysicalDeviceProcAddr nextPhysDevProcAddr, VkInstance instance) {
-    auto instanceDispatch = InstanceDispatches.create(instance, nextInstanceProcAddr, instance, nextPhysDevProcAddr);
-
-    uint32_t physicalDeviceCount;
-    VkResult res = instanceDispatch->EnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
-    assert(res == VK_SUCCESS); // Not like we can do anything else with the result lol.
-    if (res != VK_SUCCESS) return;
-    std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
-    res = instanceDispatch->EnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data());
-    assert(res == VK_SUCCESS); // Not like we can do anything else with the result lol.
-    if (res != VK_SUCCESS) return;
-
-    instanceDispatch->PhysicalDevices.resize(physicalDevices.size());
-    instanceDispatch->PhysicalDeviceDispatches.resize(physicalDevices.size());
-    for (VkPhysicalDevice physicalDevice : physicalDevices) {
-      const vkroots::VkPhysicalDeviceDispatch *pPhysicalDeviceDispatch = tables::AssignDispatchTable(physicalDevice, instanceDispatch);
-      instanceDispatch->PhysicalDevices.push_back(physicalDevice);
-      instanceDispatch->PhysicalDeviceDispatches.push_back(pPhysicalDeviceDispatch);
-    }
+  inline VkQueueDispatch* DispatchAllocator<VkQueueDispatch>::create(VkQueue queue, const VkDeviceDispatch* pDeviceDispatch) {
+    return pDeviceDispatch->QueueSlab.create(queue, pDeviceDispatch);
   }
 
-  static inline void CreateDispatchTable(const VkDeviceCreateInfo* pCreateInfo, PFN_vkGetDeviceProcAddr nextProcAddr, VkPhysicalDevice physicalDevice, VkDevice device) {
-    auto physicalDeviceDispatch = vkroots::LookupDispatch(physicalDevice);
-    auto deviceDispatch = DeviceDispatches.create(device, nextProcAddr, device, physicalDevice, physicalDeviceDispatch, pCreateInfo);
+  inline VkCommandBufferDispatch* DispatchAllocator<VkCommandBufferDispatch>::create(VkCommandBuffer cmdBuffer, const VkDeviceDispatch* pDeviceDispatch) {
+    return pDeviceDispatch->CommandBufferSlab.create(cmdBuffer, pDeviceDispatch);
+  }
+
+#ifdef VKROOTS_CHILD_DISPATCH_BY_KEY
+  static inline ChildDispatch<VkQueueDispatch> ResolveDispatch(VkQueue queue) {
+    return ChildDispatch<VkQueueDispatch>(queue, tables::DeviceDispatches.findKey(reinterpret_cast<uintptr_t>(GetDispatchKey(queue))));
+  }
 
-    for (uint32_t i = 0; i < pCreateInfo->queueCreateInfoCount; i++) {
-      const auto &queueInfo = pCreateInfo->pQueueCreateInfos[i];
-      for (uint32_t j = 0; j < queueInfo.queueCount; j++) {
-        VkQueue queue;
-        deviceDispatch->GetDeviceQueue(device, queueInfo.queueFamilyIndex, j, &queue);
+  static inline ChildDispatch<VkCommandBufferDispatch> ResolveDispatch(VkCommandBuffer cmdBuffer) {
+    return ChildDispatch<VkCommandBufferDispatch>(cmdBuffer, tables::DeviceDispatches.findKey(reinterpret_cast<uintptr_t>(GetDispatchKey(cmdBuffer))));
+  }
+#endif
 
-        tables::AssignDispatchTable(queue, deviceDispatch);
-      }
-    }
+}
+
+namespace vkroots::tables {
+
+  static inline VKROOTS_COLD void CreateDispatchTable(const VkInstanceCreateInfo* pCreateInfo, PFN_vkGetInstanceProcAddr nextInstanceProcAddr, PFN_GetPhysicalDeviceProcAddr nextPhysDevProcAddr, VkInstance instance, InstanceTracking tracking) {
+    // Physical devices get their dispatch tables as they are enumerated.
+    InstanceDispatches.create(instance, nextInstanceProcAddr, instance, nextPhysDevProcAddr, pCreateInfo, tracking);
+  }
+
+  static inline VKROOTS_COLD void CreateDispatchTable(const VkDeviceCreateInfo* pCreateInfo, PFN_vkGetDeviceProcAddr nextProcAddr, VkPhysicalDevice physicalDevice, VkDevice device) {
+    auto physicalDeviceDispatch = vkroots::LookupDispatch(physicalDevice);
+    // Queues get their dispatch tables as the app asks for them.
+    DeviceDispatches.create(device, nextProcAddr, device, physicalDevice, physicalDeviceDispatch, pCreateInfo);
   }
 
-  static inline void DestroyDispatchTable(VkInstance instance) {
+  static inline VKROOTS_COLD void DestroyDispatchTable(VkInstance instance) {
     const VkInstanceDispatch* instanceDispatch = InstanceDispatches.find(instance);
     assert(instanceDispatch);
     if (!instanceDispatch)
       return;
 
-    uint32_t physicalDeviceCount;
-    VkResult res = instanceDispatch->EnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
-    assert(res == VK_SUCCESS); // Not like we can do anything else with the result lol.
-    if (res == VK_SUCCESS) {
-      std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
-      res = instanceDispatch->EnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data());
-      assert(res == VK_SUCCESS); // Not like we can do anything else with the result lol.
-      if (res == VK_SUCCESS) {
-        for (VkPhysicalDevice physicalDevice : physicalDevices)
-          tables::UnassignDispatchTable(physicalDevice);
-      }
-    }
+    for (VkPhysicalDevice physicalDevice : instanceDispatch->PhysicalDevices)
+      tables::UnassignDispatchTable(physicalDevice);
 
     InstanceDispatches.erase(instance);
   }
 
-  static inline void DestroyDispatchTable(VkDevice device) {
+  static inline VKROOTS_COLD void DestroyDispatchTable(VkDevice device) {
     const VkDeviceDispatch* deviceDispatch = DeviceDispatches.find(device);
     assert(deviceDispatch);
     if (!deviceDispatch)
       return;
 
-    for (const auto& queueInfo : deviceDispatch->DeviceQueueInfos) {
-      for (uint32_t i = 0; i < queueInfo.queueCount; i++) {
-        VkQueue queue;
-        deviceDispatch->GetDeviceQueue(device, queueInfo.queueFamilyIndex, i, &queue);
-        tables::UnassignDispatchTable(queue);
-      }
-    }
+    // Everything still living in the device's slabs has to leave the tables
+    // before the slabs go away with the device, that includes command buffers
+    // the app never freed. Command buffer dispatches are destroyed by their slabs.
+    std::vector<VkQueue> queues;
+    deviceDispatch->Queues.forEach([&](const VkQueueDispatch& queueDispatch) { queues.push_back(queueDispatch.Queue); });
+    for (VkQueue queue : queues)
+      tables::UnassignDispatchTable(queue);
+
+    std::vector<VkCommandBuffer> cmdBuffers;
+    auto collectCmdBuffer = [&](const VkCommandBufferDispatch& cmdBufferDispatch) { cmdBuffers.push_back(cmdBufferDispatch.CommandBuffer); };
+    deviceDispatch->CommandBufferSlab.forEach(collectCmdBuffer);
+    deviceDispatch->CommandPoolArenas.forEach([&](VkCommandPool, const CommandPoolArena& arena) { arena.forEach(collectCmdBuffer); });
+    tables::ReleaseDispatchTables(uint32_t(cmdBuffers.size()), cmdBuffers.data());
 
     DeviceDispatches.erase(device);
   }
 
+  static inline void AssignDispatchTable(VkQueue queue, uint32_t familyIndex, uint32_t queueIndex, VkDeviceQueueCreateFlags flags, const VkDeviceDispatch *pDispatch) {
+    if constexpr (!TracksChildDispatches)
+      return;
+
+    // A queue that doesn't match its create flags comes back as VK_NULL_HANDLE.
+    if (queue == VK_NULL_HANDLE)
+      return;
+
+    pDispatch->Queues.assign(familyIndex, queueIndex, flags, [&] { return tables::AssignDispatchTable(queue, pDispatch); });
+  }
+
+  static inline void AssignDispatchTables(uint32_t count, const VkPhysicalDevice *pPhysDevs, const VkInstanceDispatch *pDispatch) {
+    std::unique_lock lock(pDispatch->PhysicalDeviceMutex);
+    for (uint32_t i = 0; i < count; i++) {
+      // Handles stay the same for the instance's lifetime, only new ones
+      // (eg. hotplugged GPUs) need a table.
+      if (std::ranges::find(pDispatch->PhysicalDevices, pPhysDevs[i]) != pDispatch->PhysicalDevices.end())
+        continue;
+      pDispatch->PhysicalDevices.push_back(pPhysDevs[i]);
+      pDispatch->PhysicalDeviceDispatches.push_back(tables::AssignDispatchTable(pPhysDevs[i], pDispatch));
+    }
+  }
+
+  static inline void AssignDispatchTables(uint32_t count, const VkPhysicalDeviceGroupProperties *pGroups, const VkInstanceDispatch *pDispatch) {
+    for (uint32_t i = 0; i < count; i++)
+      AssignDispatchTables(pGroups[i].physicalDeviceCount, pGroups[i].physicalDevices, pDispatch);
+  }
+
+  static inline void AssignDispatchTables(uint32_t count, const VkCommandBuffer *pCmdBuffers, VkCommandPool commandPool, const VkDeviceDispatch *pDispatch) {
+    if constexpr (!TracksChildDispatches)
+      return;
+
+    // Pools are externally synchronized, nobody else can be creating this one.
+    CommandPoolArena* arena = pDispatch->CommandPoolArenas.find(commandPool);
+    if (!arena)
+      arena = pDispatch->CommandPoolArenas.create(commandPool);
+
+    arena->reserve(count);
+    CommandBufferDispatches.createMany(count, pCmdBuffers, pDispatch, arena);
+  }
+
+  static inline VKROOTS_COLD void DestroyCommandPoolTable(VkCommandPool commandPool, const VkDeviceDispatch *pDispatch) {
+    const CommandPoolArena* arena = pDispatch->CommandPoolArenas.find(commandPool);
+    if (!arena)
+      return;
+
+    // Destroying a pool implicitly frees all of its command buffers.
+    // Their keys still leave the table one at a time as it's shared by every pool,
+    // but under a single lock, and the dispatches go with the arena in one pass
+    // rather than each going back on its freelist.
+    std::vector<VkCommandBuffer> cmdBuffers;
+    arena->forEach([&](const VkCommandBufferDispatch& cmdBufferDispatch) { cmdBuffers.push_back(cmdBufferDispatch.CommandBuffer); });
+    tables::ReleaseDispatchTables(uint32_t(cmdBuffers.size()), cmdBuffers.data());
+
+    pDispatch->CommandPoolArenas.erase(commandPool);
+  }
+
 }
 
@@ -0,0 +1,52 @@
+  // The API version and extensions an instance or device was created with.
+  // Dispatch tables only resolve the functions these make available,
+  // the others are left null.
+  class EnabledApi {
+  public:
+    EnabledApi() = default;
+
+    EnabledApi(const VkInstanceCreateInfo* pCreateInfo) {
+      if (pCreateInfo->pApplicationInfo)
+        m_apiVersion = NormalizeVersion(pCreateInfo->pApplicationInfo->apiVersion);
+      Enable(pCreateInfo->enabledExtensionCount, pCreateInfo->ppEnabledExtensionNames);
+    }
+
+    // Devices get the lower of the instance's and the physical device's version,
+    // and see the instance extensions too.
+    EnabledApi(const EnabledApi& instance, uint32_t physicalDeviceVersion, const VkDeviceCreateInfo* pCreateInfo)
+      : m_apiVersion(std::min(instance.m_apiVersion, NormalizeVersion(physicalDeviceVersion)))
+      , m_extensions(instance.m_extensions) {
+      Enable(pCreateInfo->enabledExtensionCount, pCreateInfo->ppEnabledExtensionNames);
+    }
+
+    bool HasVersion(uint32_t version) const {
+      return m_apiVersion >= version;
+    }
+
+    bool Has(Extension extension) const {
+      return m_extensions[uint32_t(extension)];
+    }
+
+    uint32_t ApiVersion() const {
+      return m_apiVersion;
+    }
+  private:
+    // Only major and minor matter, 0 means 1.0.
+    static uint32_t NormalizeVersion(uint32_t version) {
+      if (!version)
+        return VK_API_VERSION_1_0;
+      return VK_MAKE_API_VERSION(0, VK_API_VERSION_MAJOR(version), VK_API_VERSION_MINOR(version), 0);
+    }
+
+    void Enable(uint32_t count, const char* const* ppNames) {
+      for (uint32_t i = 0; i < count; i++) {
+        Extension extension = LookupExtension(ppNames[i]);
+        if (extension != Extension::Count)
+          m_extensions[uint32_t(extension)] = true;
+      }
+    }
+
+    uint32_t m_apiVersion = VK_API_VERSION_1_0;
+    std::bitset<uint32_t(Extension::Count)> m_extensions;
+  };
+
@@ -85,8 +85,12 @@ namespace vkroots {
   }
 
   // RwLock impl by doitsujin
+  //
+  // Threads about to sleep set WaitBit first, so releasing the lock
+  // only has to notify when somebody is actually waiting.
   class RwLock {
     static constexpr uint32_t ReadBit  = 1u;
+    static constexpr uint32_t WaitBit  = 1u << 30u;
     static constexpr uint32_t WriteBit = 1u << 31u;
   public:
 
@@ -99,128 +103,1993 @@ namespace vkroots {
     void lock() {
       auto value = m_lock.load(std::memory_order_relaxed);
 
-      while (value || !m_lock.compare_exchange_strong(value, WriteBit, std::memory_order_acquire, std::memory_order_relaxed)) {
-        m_lock.wait(value, std::memory_order_acquire);
-        value = m_lock.load(std::memory_order_relaxed);
+      for (;;) {
+        if (!(value & ~WaitBit)) {
+          // Keep WaitBit, other waiters still need to be woken on unlock.
+          if (m_lock.compare_exchange_weak(value, value | WriteBit, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+          continue;
+        }
+        value = wait(value);
+      }
+    }
+
+    bool try_lock() {
+      auto value = m_lock.load(std::memory_order_relaxed);
+
+      if (value & ~WaitBit)
+        return false;
+
+      return m_lock.compare_exchange_strong(value, value | WriteBit, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+      if (m_lock.exchange(0u, std::memory_order_release) & WaitBit)
+        m_lock.notify_all();
+    }
+
+    void lock_shared() {
+      auto value = m_lock.load(std::memory_order_relaxed);
+
+      for (;;) {
+        if (!(value & WriteBit)) {
+          if (m_lock.compare_exchange_weak(value, value + ReadBit, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+          continue;
+        }
+        value = wait(value);
+      }
+    }
+
+    bool try_lock_shared() {
+      auto value = m_lock.load(std::memory_order_relaxed);
+
+      if (value & WriteBit)
+        return false;
+
+      return m_lock.compare_exchange_strong(value, value + ReadBit, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock_shared() {
+      auto value = m_lock.fetch_sub(ReadBit, std::memory_order_release) - ReadBit;
+
+      // Only the last reader can unblock a writer. If the CAS fails somebody
+      // else took the lock in the meantime and notifies on their unlock.
+      if (value == WaitBit && m_lock.compare_exchange_strong(value, 0u, std::memory_order_relaxed))
+        m_lock.notify_all();
+    }
+
+  private:
+
+    uint32_t wait(uint32_t value) {
+      if (!(value & WaitBit) && !m_lock.compare_exchange_weak(value, value | WaitBit, std::memory_order_relaxed))
+        return value;
+
+      m_lock.wait(value | WaitBit, std::memory_order_relaxed);
+      return m_lock.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> m_lock = { 0u };
+
+  };
+
+  // Reader-biased wrapper around RwLock, after BRAVO (Dice & Kogan, 2019).
+  //
+  // While the lock is biased, readers don't touch the lock word at all but
+  // publish the lock in a reader slot of their own.
+  // A writer revokes the bias and waits for those slots to drain,
+  // readers then go through the RwLock until the bias is re-enabled,
+  // which is held off for a while proportional to how long revocation took.
+  //
+  // Slots are handed out per thread, threads that find none free just
+  // always take the slow path.
+  class BravoRwLock {
+    static constexpr uint32_t InhibitMultiplier = 9;
+  public:
+
+    struct alignas(64) ReaderSlot {
+      std::atomic<const BravoRwLock*> lock  = { nullptr };
+      std::atomic<bool>               owned = { false };
+    };
+
+    static constexpr size_t SlotCount = 256;
+
+    BravoRwLock() = default;
+
+    BravoRwLock(const BravoRwLock&) = delete;
+
+    BravoRwLock& operator = (const BravoRwLock&) = delete;
+
+    void lock() {
+      m_lock.lock();
+      revokeBias();
+    }
+
+    bool try_lock() {
+      if (!m_lock.try_lock())
+        return false;
+      revokeBias();
+      return true;
+    }
+
+    void unlock() {
+      m_lock.unlock();
+    }
+
+    void lock_shared() {
+      if (tryLockBiased())
+        return;
+
+      m_lock.lock_shared();
+
+      // No writer can be inside while we hold the lock shared.
+      if (!m_bias.load(std::memory_order_relaxed) && Clock::now().time_since_epoch().count() >= m_inhibitUntil.load(std::memory_order_relaxed))
+        m_bias.store(true, std::memory_order_release);
+    }
+
+    bool try_lock_shared() {
+      return tryLockBiased() || m_lock.try_lock_shared();
+    }
+
+    void unlock_shared() {
+      ReaderSlot* slot = threadSlot();
+
+      if (slot && slot->lock.load(std::memory_order_relaxed) == this)
+        slot->lock.store(nullptr, std::memory_order_release);
+      else
+        m_lock.unlock_shared();
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    bool tryLockBiased() {
+      if (!m_bias.load(std::memory_order_relaxed))
+        return false;
+
+      // Slot is still in use if we already hold another lock through it.
+      ReaderSlot* slot = threadSlot();
+      if (!slot || slot->lock.load(std::memory_order_relaxed))
+        return false;
+
+      slot->lock.store(this, std::memory_order_relaxed);
+      // Pairs with the fence in revokeBias, either we see the bias
+      // revoked or the writer sees our slot.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      // Acquire pairs with the store re-enabling the bias after the last writer.
+      if (m_bias.load(std::memory_order_acquire))
+        return true;
+
+      slot->lock.store(nullptr, std::memory_order_relaxed);
+      return false;
+    }
+
+    void revokeBias() {
+      if (!m_bias.load(std::memory_order_relaxed))
+        return;
+
+      m_bias.store(false, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      const auto start = Clock::now();
+      for (auto& slot : Slots()) {
+        while (slot.lock.load(std::memory_order_acquire) == this)
+          std::this_thread::yield();
+      }
+      const auto end = Clock::now();
+
+      m_inhibitUntil.store((end + (end - start) * InhibitMultiplier).time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    static std::array<ReaderSlot, SlotCount>& Slots() {
+      static std::array<ReaderSlot, SlotCount> slots;
+      return slots;
+    }
+
+    static ReaderSlot* threadSlot() {
+      struct Holder {
+        Holder() {
+          for (auto& candidate : Slots()) {
+            bool expected = false;
+            if (candidate.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+              slot = &candidate;
+              break;
+            }
+          }
+        }
+
+        ~Holder() {
+          if (slot)
+            slot->owned.store(false, std::memory_order_release);
+        }
+
+        ReaderSlot* slot = nullptr;
+      };
+      static thread_local Holder holder;
+      return holder.slot;
+    }
+
+    RwLock                    m_lock;
+    std::atomic<bool>         m_bias         = { true };
+    std::atomic<Clock::rep>   m_inhibitUntil = { 0 };
+  };
+
+  // Define VKROOTS_RWLOCK_BRAVO before including vkroots.h to have ObjectMap use BravoRwLock.
+#ifdef VKROOTS_RWLOCK_BRAVO
+  using ObjectMapLock = BravoRwLock;
+#else
+  using ObjectMapLock = RwLock;
+#endif
+
+  template <typename K>
+  static inline uint64_t HashHandle(const K& key) {
+    uint64_t h;
+    if constexpr (std::is_pointer<K>::value)
+      h = uint64_t(reinterpret_cast<uintptr_t>(key));
+    else
+      h = uint64_t(key);
+    // fmix64 from MurmurHash3, handles are mostly alignment in the low bits.
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // FNV-1a over a function or extension name, the GetProcAddr implementations
+  // switch on it so a lookup is one hash and one strcmp instead of a strcmp per function.
+  // make_vkroots checks the generated names don't collide.
+  constexpr uint64_t ProcNameHash(const char* name) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (; *name; name++) {
+      h ^= uint8_t(*name);
+      h *= 0x100000001b3ull;
+    }
+    return h;
+  }
+
+  // A next layer function pointer in a dispatch table.
+  //
+  // By default every function is resolved when the dispatch table is created.
+  // Define VKROOTS_LAZY_NEXT_PROCS before including vkroots.h to resolve them on
+  // first call instead, which keeps instance and device creation from doing
+  // hundreds of GetProcAddr calls for functions that are never used.
+  // Racing threads resolve the same pointer, so whoever publishes last is fine.
+#ifdef VKROOTS_LAZY_NEXT_PROCS
+  template <typename PFN, bool Used = true>
+  class NextProc {
+  public:
+    template <typename PFN_GetProcAddr, typename Handle>
+    void init(PFN_GetProcAddr, Handle, const char*) {
+    }
+
+    template <typename PFN_GetProcAddr, typename Handle>
+    PFN get(PFN_GetProcAddr getProcAddr, Handle handle, const char* name) const {
+      PFN pfn = m_pfn.load(std::memory_order_acquire);
+      if (!pfn) [[unlikely]] {
+        pfn = reinterpret_cast<PFN>(getProcAddr(handle, name));
+        m_pfn.store(pfn, std::memory_order_release);
+      }
+      return pfn;
+    }
+  private:
+    mutable std::atomic<PFN> m_pfn = nullptr;
+  };
+#else
+  template <typename PFN, bool Used = true>
+  class NextProc {
+  public:
+    template <typename PFN_GetProcAddr, typename Handle>
+    void init(PFN_GetProcAddr getProcAddr, Handle handle, const char* name) {
+      m_pfn = reinterpret_cast<PFN>(getProcAddr(handle, name));
+    }
+
+    template <typename PFN_GetProcAddr, typename Handle>
+    PFN get(PFN_GetProcAddr, Handle, const char*) const {
+      return m_pfn;
+    }
+
+    bool operator==(const NextProc&) const = default;
+  private:
+    PFN m_pfn = nullptr;
+  };
+#endif
+
+  // Define VKROOTS_USED_FUNCTIONS to a list of function names before including vkroots.h,
+  // eg. "vkCreateImage", "vkQueueSubmit", to only keep those in the dispatch tables.
+  // What vkroots needs itself is always kept.
+  // Anything else takes no space and is looked up again on every call,
+  // so hooking a function that isn't listed is a compile error.
+#ifdef VKROOTS_USED_FUNCTIONS
+  inline constexpr std::string_view UsedFunctions[] = { VKROOTS_USED_FUNCTIONS };
+
+  constexpr bool UsesFunction(std::string_view name) {
+    for (std::string_view used : UsedFunctions) {
+      if (used == name)
+        return true;
+    }
+    return false;
+  }
+#else
+  constexpr bool UsesFunction(std::string_view) {
+    return true;
+  }
+#endif
+
+  // UsesFunction for the wrapper of a hooked function, only checked once the wrapper is instantiated.
+  template <typename Overrides>
+  constexpr bool HookUsesFunction(std::string_view name) {
+    return UsesFunction(name);
+  }
+
+  template <typename PFN>
+  class NextProc<PFN, false> {
+  public:
+    template <typename PFN_GetProcAddr, typename Handle>
+    void init(PFN_GetProcAddr, Handle, const char*) {
+    }
+
+    template <typename PFN_GetProcAddr, typename Handle>
+    PFN get(PFN_GetProcAddr getProcAddr, Handle handle, const char* name) const {
+      return reinterpret_cast<PFN>(getProcAddr(handle, name));
+    }
+
+    bool operator==(const NextProc&) const = default;
+  };
+
+  // How much of the next layer an instance dispatch table resolves up front.
+  //
+  // Layers without instance overrides get DeviceOnly, which only resolves what's
+  // needed to chain device creation and track physical devices.
+  enum class InstanceTracking {
+    Full,
+    DeviceOnly,
+  };
+
+  // A next layer function pointer in an instance dispatch table.
+  // Anything the table didn't resolve up front, eg. what a DeviceOnly table skips,
+  // is looked up on its first call and kept. What it did resolve isn't looked up
+  // again even if the next layer returned nothing, it doesn't have the function.
+  // Shared tables resolved everything else the same, so they share this too.
+  template <typename PFN, bool Used = true>
+  class InstanceNextProc : public NextProc<PFN, Used> {
+  public:
+    template <typename PFN_GetProcAddr, typename Handle>
+    void init(PFN_GetProcAddr getProcAddr, Handle handle, const char* name) {
+      NextProc<PFN, Used>::init(getProcAddr, handle, name);
+      m_resolved.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename PFN_GetProcAddr, typename Handle>
+    PFN get(PFN_GetProcAddr getProcAddr, Handle handle, const char* name) const {
+      if (PFN pfn = NextProc<PFN, Used>::get(getProcAddr, handle, name)) [[likely]]
+        return pfn;
+
+      if (m_resolved.load(std::memory_order_acquire))
+        return m_deferred.load(std::memory_order_relaxed);
+
+      // Racing threads look up the same function, either result will do.
+      PFN pfn = reinterpret_cast<PFN>(getProcAddr(handle, name));
+      m_deferred.store(pfn, std::memory_order_relaxed);
+      m_resolved.store(true, std::memory_order_release);
+      return pfn;
+    }
+
+    bool operator==(const InstanceNextProc& other) const {
+      return NextProc<PFN, Used>::operator==(other) && m_resolved.load(std::memory_order_relaxed) == other.m_resolved.load(std::memory_order_relaxed);
+    }
+  private:
+    mutable std::atomic<PFN>  m_deferred = nullptr;
+    mutable std::atomic<bool> m_resolved = false;
+  };
+
+  // Functions left out with VKROOTS_USED_FUNCTIONS are looked up on every call anyway.
+  template <typename PFN>
+  class InstanceNextProc<PFN, false> : public NextProc<PFN, false> {
+  public:
+    bool operator==(const InstanceNextProc&) const = default;
+  };
+
+  // Holds the next layer functions of an instance or device dispatch table.
+  //
+  // The dispatch table fills in what prepare() returns and then calls publish().
+  // Define VKROOTS_SHARED_PROCS before including vkroots.h to have tables that
+  // resolved the exact same functions share one refcounted copy of them, eg.
+  // for processes making lots of devices on the same driver.
+  // Otherwise the functions are stored inline.
+#ifdef VKROOTS_SHARED_PROCS
+#ifdef VKROOTS_LAZY_NEXT_PROCS
+#error "VKROOTS_SHARED_PROCS can't be used with VKROOTS_LAZY_NEXT_PROCS, there's nothing resolved to share."
+#endif
+  template <typename Procs>
+  class ProcTable {
+  public:
+    ProcTable() = default;
+
+    ProcTable(const ProcTable&) = delete;
+    ProcTable& operator=(const ProcTable&) = delete;
+
+    ~ProcTable() {
+      if (!m_entry)
+        return;
+      std::unique_lock lock(s_mutex);
+      if (--m_entry->refs)
+        return;
+      std::erase(s_entries, m_entry);
+      delete m_entry;
+    }
+
+    Procs& prepare() {
+      m_entry = new Entry();
+      return m_entry->procs;
+    }
+
+    void publish() {
+      std::unique_lock lock(s_mutex);
+      for (Entry* entry : s_entries) {
+        if (entry->procs == m_entry->procs) {
+          entry->refs++;
+          delete m_entry;
+          m_entry = entry;
+          return;
+        }
       }
+      s_entries.push_back(m_entry);
+    }
+
+    const Procs* operator->() const {
+      return &m_entry->procs;
+    }
+
+    const Procs* get() const {
+      return &m_entry->procs;
+    }
+  private:
+    struct Entry {
+      Procs procs = {};
+      uint32_t refs = 1;
+    };
+
+    Entry* m_entry = nullptr;
+
+    static inline std::mutex s_mutex;
+    static inline std::vector<Entry*> s_entries;
+  };
+#else
+  template <typename Procs>
+  class ProcTable {
+  public:
+    Procs& prepare() {
+      return m_procs;
+    }
+
+    void publish() {
+    }
+
+    const Procs* operator->() const {
+      return &m_procs;
+    }
+
+    const Procs* get() const {
+      return &m_procs;
+    }
+  private:
+    Procs m_procs;
+  };
+#endif
+
+  // Open addressing hash map for handle keys.
+  //
+  // Slots are split into groups of 16 with one tag byte each, a group's tags
+  // are matched against the hash in one go with SSE2 or NEON.
+  // Keys and values are stored inline in the slot array, so a lookup is
+  // one tag compare and one key compare in the common case.
+  //
+  // Instead of tombstones, each group counts how many keys probed past it
+  // because it was full. Lookups stop at the first group without overflow,
+  // and erasing walks the probe path again to decrement the counts.
+  //
+  // Value must be default constructible, an empty slot holds Value{}.
+  template <typename K, typename Value>
+  class FlatMap {
+    static constexpr uint32_t GroupSize = 16;
+    static constexpr uint8_t  EmptyTag  = 0;
+
+    struct alignas(16) Group {
+      uint8_t  tags[GroupSize] = {};
+      uint32_t overflow = 0;
+    };
+
+    struct Slot {
+      K     key{};
+      Value value{};
+    };
+
+    // One bit per matching slot, in slot order.
+    class GroupMatch {
+    public:
+#if defined(VKROOTS_FLATMAP_NEON)
+      // vshrn gives us a nibble per tag, keep one bit of each.
+      static constexpr uint32_t Stride = 4;
+      explicit GroupMatch(uint64_t mask) : m_mask(mask & 0x8888888888888888ull) {}
+#else
+      static constexpr uint32_t Stride = 1;
+      explicit GroupMatch(uint64_t mask) : m_mask(mask) {}
+#endif
+
+      explicit operator bool() const { return m_mask != 0; }
+
+      uint32_t index() const { return uint32_t(std::countr_zero(m_mask)) / Stride; }
+
+      void next() { m_mask &= m_mask - 1; }
+
+    private:
+      uint64_t m_mask;
+    };
+
+    static GroupMatch match(const Group& group, uint8_t tag) {
+#if defined(VKROOTS_FLATMAP_SSE2)
+      const __m128i tags = _mm_load_si128(reinterpret_cast<const __m128i*>(group.tags));
+      return GroupMatch(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(char(tag))))));
+#elif defined(VKROOTS_FLATMAP_NEON)
+      const uint8x16_t eq = vceqq_u8(vld1q_u8(group.tags), vdupq_n_u8(tag));
+      return GroupMatch(vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0));
+#else
+      uint64_t mask = 0;
+      for (uint32_t i = 0; i < GroupSize; i++)
+        mask |= uint64_t(group.tags[i] == tag) << i;
+      return GroupMatch(mask);
+#endif
+    }
+
+    static uint64_t hash(const K& key) {
+      return HashHandle(key);
+    }
+
+    // Top bit is always set so a full slot never looks empty.
+    static uint8_t tagOf(uint64_t h) { return uint8_t(h >> 57) | 0x80u; }
+
+  public:
+    FlatMap() = default;
+
+    FlatMap(const FlatMap&) = delete;
+
+    FlatMap& operator = (const FlatMap&) = delete;
+
+    size_t size() const {
+      return m_size;
+    }
+
+    // How many slots there are, including the empty ones.
+    size_t capacity() const {
+      return m_groups ? (m_groupMask + 1) * GroupSize : 0;
+    }
+
+    Value *find(const K& key) {
+      const size_t index = locate(key);
+      return index != npos ? &m_slots[index].value : nullptr;
+    }
+
+    const Value *find(const K& key) const {
+      const size_t index = locate(key);
+      return index != npos ? &m_slots[index].value : nullptr;
+    }
+
+    // Returns the value for key, and whether it was newly inserted.
+    template <typename... Args>
+    std::pair<Value*, bool> emplace(const K& key, Args&&... args) {
+      if (Value* value = find(key))
+        return std::make_pair(value, false);
+
+      reserve(m_size + 1);
+
+      const uint64_t h = hash(key);
+      for (size_t g = h & m_groupMask;; g = (g + 1) & m_groupMask) {
+        Group& group = m_groups[g];
+        GroupMatch empty = match(group, EmptyTag);
+        if (!empty) {
+          group.overflow++;
+          continue;
+        }
+
+        const size_t index = g * GroupSize + empty.index();
+        group.tags[empty.index()] = tagOf(h);
+        m_slots[index].key   = key;
+        m_slots[index].value = Value(std::forward<Args>(args)...);
+        m_size++;
+        return std::make_pair(&m_slots[index].value, true);
+      }
+    }
+
+    bool erase(const K& key) {
+      const size_t index = locate(key);
+      if (index == npos)
+        return false;
+
+      const size_t home = hash(key) & m_groupMask;
+      const size_t found = index / GroupSize;
+      for (size_t g = home; g != found; g = (g + 1) & m_groupMask)
+        m_groups[g].overflow--;
+
+      m_groups[found].tags[index % GroupSize] = EmptyTag;
+      m_slots[index] = Slot{};
+      m_size--;
+      return true;
+    }
+
+    // Grows so that count entries fit without another rehash.
+    void reserve(size_t count) {
+      // Keep at most 14 of every 16 slots full so probe chains stay short.
+      size_t groupCount = m_groupMask + 1;
+      if (m_groups && count <= groupCount * 14)
+        return;
+
+      const size_t oldCount = m_groups ? groupCount : 0;
+
+      groupCount = m_groups ? groupCount : 1;
+      while (count > groupCount * 14)
+        groupCount *= 2;
+
+      auto oldGroups = std::move(m_groups);
+      auto oldSlots  = std::move(m_slots);
+
+      m_groups    = std::make_unique<Group[]>(groupCount);
+      m_slots     = std::make_unique<Slot[]>(groupCount * GroupSize);
+      m_groupMask = groupCount - 1;
+      m_size      = 0;
+
+      for (size_t g = 0; g < oldCount; g++) {
+        for (uint32_t i = 0; i < GroupSize; i++) {
+          if (oldGroups[g].tags[i] != EmptyTag)
+            emplace(oldSlots[g * GroupSize + i].key, std::move(oldSlots[g * GroupSize + i].value));
+        }
+      }
+    }
+
+    template <typename Func>
+    void forEach(Func func) {
+      if (!m_groups)
+        return;
+
+      for (size_t g = 0; g <= m_groupMask; g++) {
+        for (uint32_t i = 0; i < GroupSize; i++) {
+          if (m_groups[g].tags[i] != EmptyTag)
+            func(m_slots[g * GroupSize + i].key, m_slots[g * GroupSize + i].value);
+        }
+      }
+    }
+    template <typename Func>
+    void forEach(Func func) const {
+      if (!m_groups)
+        return;
+
+      for (size_t g = 0; g <= m_groupMask; g++) {
+        for (uint32_t i = 0; i < GroupSize; i++) {
+          if (m_groups[g].tags[i] != EmptyTag)
+            func(m_slots[g * GroupSize + i].key, m_slots[g * GroupSize + i].value);
+        }
+      }
+    }
+
+  private:
+    static constexpr size_t npos = ~size_t(0);
+
+    size_t locate(const K& key) const {
+      if (!m_groups)
+        return npos;
+
+      const uint64_t h = hash(key);
+      const uint8_t tag = tagOf(h);
+      size_t g = h & m_groupMask;
+      for (size_t n = 0; n <= m_groupMask; n++, g = (g + 1) & m_groupMask) {
+        const Group& group = m_groups[g];
+        for (GroupMatch m = match(group, tag); m; m.next()) {
+          const size_t index = g * GroupSize + m.index();
+          if (m_slots[index].key == key)
+            return index;
+        }
+
+        if (!group.overflow)
+          return npos;
+      }
+      return npos;
+    }
+
+    std::unique_ptr<Group[]> m_groups;
+    std::unique_ptr<Slot[]>  m_slots;
+    size_t                   m_groupMask = 0;
+    size_t                   m_size = 0;
+  };
+
+  // Epoch based reclamation.
+  //
+  // Readers announce the global epoch in a per-thread record for the duration of
+  // a lookup and clear it afterwards, they never take a lock or write to shared memory.
+  // Writers unlink memory and retire it with the epoch it was unlinked in,
+  // it's only freed once every active reader has announced a later epoch.
+  //
+  // Each thread has its own reader record per domain. Records are handed to a new
+  // thread once the thread owning them has exited, and freed with the domain,
+  // or by the owning thread if it outlives the domain.
+  class EpochDomain {
+  public:
+    struct alignas(64) Reader {
+      std::atomic<uint64_t> epoch = { 0u };
+      std::atomic<uint32_t> state = { ReaderFree };
+      Reader*               next  = nullptr;
+    };
+
+    class Guard {
+    public:
+      explicit Guard(EpochDomain& domain)
+        : m_reader(domain.reader()) {
+        m_reader->epoch.store(domain.m_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // Our announcement must be visible before we read anything a writer may retire.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+
+      ~Guard() {
+        m_reader->epoch.store(0u, std::memory_order_release);
+      }
+
+      Guard(const Guard&) = delete;
+
+      Guard& operator = (const Guard&) = delete;
+    private:
+      Reader* m_reader;
+    };
+
+    EpochDomain() = default;
+
+    ~EpochDomain() {
+      // Deleters may retire more objects, eg. a device dispatch its command pools.
+      while (!m_retired.empty()) {
+        std::vector<Retired> retired = std::move(m_retired);
+        m_retired.clear();
+        for (auto& entry : retired)
+          entry.deleter(entry.object);
+      }
+
+      // Records a thread still owns are left for it to free when it exits.
+      Reader* reader = m_readers.load(std::memory_order_relaxed);
+      while (reader) {
+        Reader* next = reader->next;
+        uint32_t owned = ReaderOwned;
+        if (!reader->state.compare_exchange_strong(owned, ReaderOrphaned, std::memory_order_acq_rel))
+          delete reader;
+        reader = next;
+      }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+
+    EpochDomain& operator = (const EpochDomain&) = delete;
+
+    // The object must already be unreachable for new readers.
+    void retire(void* object, void (*deleter)(void*)) {
+      {
+        std::unique_lock lock(m_mutex);
+        m_retired.push_back(Retired{ object, deleter, m_epoch.fetch_add(1u, std::memory_order_acq_rel) });
+      }
+
+      // Deleters retiring more objects end up here again, the outermost call frees those too.
+      if (s_reclaiming == this)
+        return;
+
+      // One thread frees at a time, so objects are freed in the order they were retired
+      // even across threads, a dispatch may still need its parent to free itself.
+      // The deleters run outside m_mutex as they may retire more objects themselves.
+      std::unique_lock reclaimLock(m_reclaimMutex);
+      s_reclaiming = this;
+      for (;;) {
+        std::vector<Retired> reclaimable;
+        {
+          std::unique_lock lock(m_mutex);
+          reclaimable = reclaim();
+        }
+
+        if (reclaimable.empty())
+          break;
+
+        for (auto& retired : reclaimable)
+          retired.deleter(retired.object);
+      }
+      s_reclaiming = nullptr;
+    }
+
+  private:
+    enum : uint32_t {
+      ReaderFree,
+      ReaderOwned,
+      // The domain is gone, the thread that owned the record frees it.
+      ReaderOrphaned,
+    };
+
+    struct Retired {
+      void*    object;
+      void     (*deleter)(void*);
+      uint64_t epoch;
+    };
+
+    // The reader records of a thread, one per domain it has used.
+    class ThreadReaders {
+    public:
+      ~ThreadReaders() {
+        for (const Entry& entry : m_entries)
+          release(entry.reader);
+      }
+
+      Reader* find(uint64_t domainId) const {
+        for (const Entry& entry : m_entries) {
+          if (entry.domainId == domainId)
+            return entry.reader;
+        }
+        return nullptr;
+      }
+
+      void add(uint64_t domainId, Reader* reader) {
+        // Drop the records of domains that are gone first.
+        std::erase_if(m_entries, [](const Entry& entry) {
+          if (entry.reader->state.load(std::memory_order_acquire) != ReaderOrphaned)
+            return false;
+          delete entry.reader;
+          return true;
+        });
+        m_entries.push_back(Entry{ domainId, reader });
+      }
+
+    private:
+      static void release(Reader* reader) {
+        uint32_t owned = ReaderOwned;
+        if (!reader->state.compare_exchange_strong(owned, ReaderFree, std::memory_order_acq_rel))
+          delete reader;
+      }
+
+      struct Entry {
+        uint64_t domainId;
+        Reader*  reader;
+      };
+
+      std::vector<Entry> m_entries;
+    };
+
+    Reader* reader() {
+      // Keyed on an id rather than the address, a new domain may reuse the address of an old one.
+      static thread_local ThreadReaders readers;
+
+      Reader* reader = readers.find(m_id);
+      if (!reader) [[unlikely]] {
+        reader = acquireReader();
+        readers.add(m_id, reader);
+      }
+      return reader;
+    }
+
+    Reader* acquireReader() {
+      for (Reader* reader = m_readers.load(std::memory_order_acquire); reader; reader = reader->next) {
+        uint32_t expected = ReaderFree;
+        if (reader->state.load(std::memory_order_relaxed) == ReaderFree && reader->state.compare_exchange_strong(expected, ReaderOwned, std::memory_order_acquire))
+          return reader;
+      }
+
+      Reader* reader = new Reader;
+      reader->state.store(ReaderOwned, std::memory_order_relaxed);
+      reader->next = m_readers.load(std::memory_order_relaxed);
+      while (!m_readers.compare_exchange_weak(reader->next, reader, std::memory_order_release, std::memory_order_relaxed))
+        ;
+      return reader;
+    }
+
+    // Takes every retired object no reader can still see out of m_retired.
+    std::vector<Retired> reclaim() {
+      // Pairs with the fence in Guard, either we see the reader's epoch
+      // or the reader sees the object already unlinked.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      uint64_t oldest = ~uint64_t(0);
+      for (Reader* reader = m_readers.load(std::memory_order_acquire); reader; reader = reader->next) {
+        const uint64_t epoch = reader->epoch.load(std::memory_order_acquire);
+        if (epoch)
+          oldest = std::min(oldest, epoch);
+      }
+
+      // Keep retirement order, epochs only grow so this is a prefix of m_retired.
+      auto end = std::stable_partition(m_retired.begin(), m_retired.end(),
+        [oldest](const Retired& retired) { return retired.epoch >= oldest; });
+      std::vector<Retired> reclaimable(end, m_retired.end());
+      m_retired.erase(end, m_retired.end());
+      return reclaimable;
+    }
+
+    static inline std::atomic<uint64_t> s_nextId = { 1u };
+    // The domain whose deleters the calling thread is running, if any.
+    static inline thread_local const EpochDomain* s_reclaiming = nullptr;
+
+    const uint64_t        m_id      = s_nextId.fetch_add(1u, std::memory_order_relaxed);
+    // 0 marks a reader as idle, so start counting at 1.
+    std::atomic<uint64_t> m_epoch   = { 1u };
+    std::atomic<Reader*>  m_readers = { nullptr };
+    std::vector<Retired>  m_retired;
+    std::mutex            m_mutex;
+    std::mutex            m_reclaimMutex;
+  };
+
+  inline EpochDomain Epochs;
+
+  // Fixed size object allocator, carves slabs of objects and recycles
+  // freed slots through a freelist. Everything is released along with the allocator,
+  // objects that are still alive are destroyed first.
+  //
+  // Slabs start at FirstSlabSize objects and double up to MaxSlabSize, a command pool
+  // holding a couple of command buffers shouldn't cost a full slab.
+  template <typename T>
+  class SlabAllocator {
+    static constexpr size_t FirstSlabSize = 4;
+    static constexpr size_t MaxSlabSize   = 64;
+
+    // Storage comes first so an object pointer is also a slot pointer.
+    // Live slots remember their allocator so objects can be destroyed on their own.
+    struct Slot {
+      alignas(T) std::byte storage[sizeof(T)];
+      union {
+        Slot*          next;
+        SlabAllocator* owner;
+      };
+      bool live;
+    };
+
+    struct Slab {
+      std::unique_ptr<Slot[]> slots;
+      size_t                  size;
+    };
+  public:
+
+    SlabAllocator() = default;
+
+    ~SlabAllocator() {
+      for (const Slab& slab : m_slabs) {
+        for (size_t i = 0; i < slab.size; i++) {
+          if (slab.slots[i].live)
+            std::destroy_at(reinterpret_cast<T*>(slab.slots[i].storage));
+        }
+      }
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+
+    SlabAllocator& operator = (const SlabAllocator&) = delete;
+
+    // Makes room for count more objects in at most one new slab,
+    // so a batch sizes the slab it lands in.
+    void reserve(size_t count) {
+      std::unique_lock lock(m_mutex);
+
+      if (m_capacity - m_live < count)
+        addSlab(count - (m_capacity - m_live));
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+      Slot* slot;
+      {
+        std::unique_lock lock(m_mutex);
+
+        if (!m_free)
+          addSlab(1);
+
+        slot = m_free;
+        m_free = slot->next;
+        slot->owner = this;
+        slot->live = true;
+        m_live++;
+      }
+
+      return std::construct_at(reinterpret_cast<T*>(slot->storage), std::forward<Args>(args)...);
+    }
+
+    static void destroy(const T* object) {
+      std::destroy_at(object);
+
+      Slot* slot = reinterpret_cast<Slot*>(const_cast<T*>(object));
+      SlabAllocator* owner = slot->owner;
+
+      std::unique_lock lock(owner->m_mutex);
+      slot->live = false;
+      slot->next = owner->m_free;
+      owner->m_free = slot;
+      owner->m_live--;
+    }
+
+    template <typename Func>
+    void forEach(Func func) const {
+      std::unique_lock lock(m_mutex);
+
+      for (const Slab& slab : m_slabs) {
+        for (size_t i = 0; i < slab.size; i++) {
+          if (slab.slots[i].live)
+            func(*reinterpret_cast<const T*>(slab.slots[i].storage));
+        }
+      }
+    }
+
+  private:
+    void addSlab(size_t minSize) {
+      const size_t size = std::max(minSize, m_slabs.empty() ? FirstSlabSize : std::min(m_slabs.back().size * 2, MaxSlabSize));
+
+      Slab& slab = m_slabs.emplace_back(Slab{ std::make_unique<Slot[]>(size), size });
+      // Hand out the slots front to back.
+      for (size_t i = size; i-- > 0;) {
+        slab.slots[i].next = m_free;
+        m_free = &slab.slots[i];
+      }
+      m_capacity += size;
+    }
+
+    std::vector<Slab>  m_slabs;
+    Slot*              m_free     = nullptr;
+    size_t             m_capacity = 0;
+    size_t             m_live     = 0;
+    mutable std::mutex m_mutex;
+  };
+
+  // One slot for every queue a device was created with, so GetDeviceQueue(2)
+  // only has to assign a queue's dispatch the first time it hands the queue out.
+  class QueueSlots {
+  public:
+    void init(uint32_t count, const VkDeviceQueueCreateInfo* pQueueInfos) {
+      uint32_t slotCount = 0;
+      for (uint32_t i = 0; i < count; i++) {
+        m_families.push_back(Family{ pQueueInfos[i].queueFamilyIndex, pQueueInfos[i].flags, slotCount, pQueueInfos[i].queueCount });
+        slotCount += pQueueInfos[i].queueCount;
+      }
+      m_slotCount = slotCount;
+      m_slots = std::make_unique<std::atomic<const VkQueueDispatch*>[]>(slotCount);
+    }
+
+    template <typename Create>
+    const VkQueueDispatch* assign(uint32_t familyIndex, uint32_t queueIndex, VkDeviceQueueCreateFlags flags, Create create) {
+      std::atomic<const VkQueueDispatch*>* slot = find(familyIndex, queueIndex, flags);
+      if (!slot)
+        return nullptr;
+
+      if (const VkQueueDispatch* dispatch = slot->load(std::memory_order_acquire))
+        return dispatch;
+
+      std::unique_lock lock(m_mutex);
+      const VkQueueDispatch* dispatch = slot->load(std::memory_order_relaxed);
+      if (!dispatch) {
+        dispatch = create();
+        slot->store(dispatch, std::memory_order_release);
+      }
+      return dispatch;
+    }
+
+    template <typename Func>
+    void forEach(Func func) const {
+      std::unique_lock lock(m_mutex);
+
+      for (uint32_t i = 0; i < m_slotCount; i++) {
+        if (const VkQueueDispatch* dispatch = m_slots[i].load(std::memory_order_relaxed))
+          func(*dispatch);
+      }
+    }
+
+  private:
+    std::atomic<const VkQueueDispatch*>* find(uint32_t familyIndex, uint32_t queueIndex, VkDeviceQueueCreateFlags flags) const {
+      for (const Family& family : m_families) {
+        if (family.index == familyIndex && family.flags == flags)
+          return queueIndex < family.count ? &m_slots[family.firstSlot + queueIndex] : nullptr;
+      }
+      return nullptr;
+    }
+
+    struct Family {
+      uint32_t                 index;
+      VkDeviceQueueCreateFlags flags;
+      uint32_t                 firstSlot;
+      uint32_t                 count;
+    };
+
+    std::vector<Family>                                    m_families;
+    std::unique_ptr<std::atomic<const VkQueueDispatch*>[]> m_slots;
+    uint32_t                                               m_slotCount = 0;
+    mutable std::mutex                                     m_mutex;
+  };
+
+  // How the dispatch tables allocate their objects.
+  template <typename V>
+  struct DispatchAllocator {
+    template <typename... Args>
+    static V* create(Args&&... args) { return new V(std::forward<Args>(args)...); }
+    static void destroy(const V* object) { delete object; }
+  };
+
+  using CommandPoolArena = SlabAllocator<VkCommandBufferDispatch>;
+
+  // Queue and command buffer dispatches live in their VkDeviceDispatch's slabs,
+  // or in the arena of the VkCommandPool they were allocated from.
+  template <>
+  struct DispatchAllocator<VkQueueDispatch> {
+    static VkQueueDispatch* create(VkQueue queue, const VkDeviceDispatch* pDeviceDispatch);
+    static void destroy(const VkQueueDispatch* object) { SlabAllocator<VkQueueDispatch>::destroy(object); }
+  };
+
+  template <>
+  struct DispatchAllocator<VkCommandBufferDispatch> {
+    static VkCommandBufferDispatch* create(VkCommandBuffer cmdBuffer, const VkDeviceDispatch* pDeviceDispatch);
+    static VkCommandBufferDispatch* create(VkCommandBuffer cmdBuffer, const VkDeviceDispatch* pDeviceDispatch, CommandPoolArena* pArena) { return pArena->create(cmdBuffer, pDeviceDispatch); }
+    static void destroy(const VkCommandBufferDispatch* object) { CommandPoolArena::destroy(object); }
+  };
+
+  // With VKROOTS_OBJECTMAP_EPOCH, dispatches erased along with their pool are
+  // only freed once readers are done with them, so the arena has to wait as well.
+  template <>
+  struct DispatchAllocator<CommandPoolArena> {
+    static CommandPoolArena* create() { return new CommandPoolArena; }
+    static void destroy(const CommandPoolArena* arena) {
+#ifdef VKROOTS_OBJECTMAP_EPOCH
+      Epochs.retire(const_cast<CommandPoolArena*>(arena), [](void* object) { delete static_cast<CommandPoolArena*>(object); });
+#else
+      delete arena;
+#endif
+    }
+  };
+
+  template <typename V>
+  struct DispatchDeleter {
+    void operator () (V* object) const { DispatchAllocator<std::remove_const_t<V>>::destroy(object); }
+  };
+
+  template <typename K, typename V>
+  class ObjectMap {
+  public:
+
+    V *find(const K& key) const {
+      std::shared_lock lock(m_lock);
+
+      auto entry = m_map.find(key);
+
+      if (!entry)
+        return nullptr;
+
+      return entry->get();
     }
 
-    bool try_lock() {
-      auto value = m_lock.load(std::memory_order_relaxed);
 
-      if (value)
-        return false;
+    template<typename... Args>
+    V* create(const K& key, Args&&... args) {
+      std::unique_lock lock(m_lock);
+
+      auto result = m_map.emplace(key);
+
+      if (!result.second)
+        return nullptr;
 
-      return m_lock.compare_exchange_strong(value, WriteBit, std::memory_order_acquire, std::memory_order_relaxed);
+      result.first->reset(DispatchAllocator<std::remove_const_t<V>>::create(std::forward<Args>(args)...));
+      return result.first->get();
     }
 
-    void unlock() {
-      m_lock.store(0u, std::memory_order_release);
-      m_lock.notify_all();
+    // Creates V(key, args...) for every key under a single lock.
+    template<typename... Args>
+    void createMany(size_t count, const K* keys, const Args&... args) {
+      std::unique_lock lock(m_lock);
+
+      m_map.reserve(m_map.size() + count);
+      for (size_t i = 0; i < count; i++) {
+        auto result = m_map.emplace(keys[i]);
+
+        if (result.second)
+          result.first->reset(DispatchAllocator<std::remove_const_t<V>>::create(keys[i], args...));
+      }
     }
 
-    void lock_shared() {
-      auto value = m_lock.load(std::memory_order_relaxed);
+    void erase(const K& key) {
+      std::unique_lock lock(m_lock);
+      if (m_map.erase(key))
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
 
-      do {
-        while (value & WriteBit) {
-          m_lock.wait(value, std::memory_order_acquire);
-          value = m_lock.load(std::memory_order_relaxed);
-        }
-      } while (!m_lock.compare_exchange_strong(value, value + ReadBit, std::memory_order_acquire, std::memory_order_relaxed));
+    void eraseMany(size_t count, const K* keys) {
+      std::unique_lock lock(m_lock);
+
+      bool erased = false;
+      for (size_t i = 0; i < count; i++)
+        erased |= m_map.erase(keys[i]);
+
+      if (erased)
+        m_generation.fetch_add(1, std::memory_order_release);
     }
 
-    bool try_lock_shared() {
-      auto value = m_lock.load(std::memory_order_relaxed);
+    // Erases keys without destroying their values, for values that go away
+    // along with whatever owns their memory, eg. a command pool's arena.
+    void releaseMany(size_t count, const K* keys) {
+      std::unique_lock lock(m_lock);
 
-      if (value & WriteBit)
-        return false;
+      bool erased = false;
+      for (size_t i = 0; i < count; i++) {
+        if (auto entry = m_map.find(keys[i])) {
+          entry->release();
+          erased |= m_map.erase(keys[i]);
+        }
+      }
 
-      return m_lock.compare_exchange_strong(value, value + ReadBit, std::memory_order_acquire, std::memory_order_relaxed);
+      if (erased)
+        m_generation.fetch_add(1, std::memory_order_release);
     }
 
-    void unlock_shared() {
-      m_lock.fetch_sub(ReadBit, std::memory_order_release);
-      m_lock.notify_one();
+    template <typename Func>
+    void forEach(Func func) const {
+      std::shared_lock lock(m_lock);
+      m_map.forEach([&](const K& key, const std::unique_ptr<V, DispatchDeleter<V>>& value) { func(key, *value); });
     }
 
+    // Bumped after every erase, lets lookup caches know their entries may be stale.
+    uint64_t generation() const {
+      return m_generation.load(std::memory_order_acquire);
+    }
   private:
+    // The dispatch objects themselves live behind a unique_ptr so they
+    // keep their address when the table grows.
+    FlatMap<K, std::unique_ptr<V, DispatchDeleter<V>>> m_map;
+    mutable ObjectMapLock m_lock;
+    std::atomic<uint64_t> m_generation = { 0u };
+  };
 
-    std::atomic<uint32_t> m_lock = { 0u };
+  // The loader writes a pointer to its own dispatch table into the first
+  // word of every dispatchable object, which is unique per VkInstance and VkDevice.
+  // Queues and command buffers share the key of their VkDevice, physical devices
+  // share the key of their VkInstance.
+  template <typename T>
+  static inline void *GetDispatchKey(T object) {
+    return *reinterpret_cast<void **>(object);
+  }
 
+  template <typename K>
+  struct DispatchKeyTraits {
+    static uintptr_t key(K object) { return reinterpret_cast<uintptr_t>(object); }
   };
 
+  template <>
+  struct DispatchKeyTraits<VkInstance> {
+    static uintptr_t key(VkInstance object) { return object ? reinterpret_cast<uintptr_t>(GetDispatchKey(object)) : 0u; }
+  };
+
+  template <>
+  struct DispatchKeyTraits<VkDevice> {
+    static uintptr_t key(VkDevice object) { return object ? reinterpret_cast<uintptr_t>(GetDispatchKey(object)) : 0u; }
+  };
+
+  // Same interface as ObjectMap, but find() never takes a lock, waits for a writer
+  // or writes to shared memory.
+  //
+  // VkInstance and VkDevice are keyed on their loader dispatch key, everything else
+  // on the handle itself as those share their parent's key.
+  //
+  // It's a linear probing table where a slot's key never changes once set,
+  // so readers can probe it while writers change it. Erasing only clears the value
+  // and leaves the key behind as a tombstone, creating the same key again reuses it.
+  // Writers serialize on a mutex. Once keys and tombstones would fill half the table
+  // it's rebuilt without the tombstones into another table.
+  // Tables are never freed while the map lives, a replaced one is reused for the next
+  // rebuild of the same size, so at most two of every size are kept. Readers retry
+  // if a rebuild started while they probed, they may have looked at a table being reused.
   template <typename K, typename V>
-  class ObjectMap {
+  class LockFreeObjectMap {
+    static constexpr size_t InitialCapacity = 64;
+
+    struct Slot {
+      std::atomic<uintptr_t> key   = { 0u };
+      std::atomic<V*>        value = { nullptr };
+    };
+
+    struct Table {
+      explicit Table(size_t capacity)
+        : mask(capacity - 1), slots(new Slot[capacity]) {
+      }
+
+      size_t home(uintptr_t key) const {
+        // Fibonacci hashing, the low bits of a pointer are mostly alignment.
+        return size_t((uint64_t(key) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+      }
+
+      size_t                  mask;
+      std::unique_ptr<Slot[]> slots;
+    };
   public:
 
-    V *find(const K& key) const {
-      std::shared_lock lock(m_lock);
+    LockFreeObjectMap() {
+      m_tables.push_back(std::make_unique<Table>(InitialCapacity));
+      m_table.store(m_tables.back().get(), std::memory_order_relaxed);
+    }
 
-      auto entry = m_map.find(key);
+    ~LockFreeObjectMap() {
+      const Table* table = m_table.load(std::memory_order_relaxed);
+      for (size_t i = 0; i <= table->mask; i++) {
+        if (V* value = table->slots[i].value.load(std::memory_order_relaxed))
+          DispatchDeleter<V>()(value);
+      }
+    }
+
+    LockFreeObjectMap(const LockFreeObjectMap&) = delete;
+
+    LockFreeObjectMap& operator = (const LockFreeObjectMap&) = delete;
+
+    V *find(const K& object) const {
+      return findKey(DispatchKeyTraits<K>::key(object));
+    }
 
-      if (entry == m_map.end())
+    // Looks up by dispatch key directly, eg. the key of a VkDevice's child.
+    V *findKey(uintptr_t key) const {
+      if (!key)
         return nullptr;
 
-      return entry->second.get();
+      for (;;) {
+        const uint64_t rebuilds = m_rebuilds.load(std::memory_order_acquire);
+        const Table* table = m_table.load(std::memory_order_acquire);
+
+        // At most half the slots have a key so this ends at an empty one,
+        // but a table being reused is only bounded by its size.
+        V* value = nullptr;
+        size_t i = table->home(key);
+        for (size_t n = 0; n <= table->mask; n++, i = (i + 1) & table->mask) {
+          const uintptr_t slotKey = table->slots[i].key.load(std::memory_order_acquire);
+
+          if (slotKey == key) {
+            value = table->slots[i].value.load(std::memory_order_acquire);
+            break;
+          }
+
+          if (!slotKey)
+            break;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_rebuilds.load(std::memory_order_relaxed) == rebuilds) [[likely]]
+          return value;
+      }
     }
 
+    template<typename... Args>
+    V* create(const K& object, Args&&... args) {
+      const uintptr_t key = DispatchKeyTraits<K>::key(object);
+
+      if (!key)
+        return nullptr;
+
+      std::unique_lock lock(m_mutex);
+
+      if (contains(key))
+        return nullptr;
+
+      reserve(1);
+      return insert(key, DispatchAllocator<std::remove_const_t<V>>::create(std::forward<Args>(args)...));
+    }
 
+    // Creates V(object, args...) for every object under a single lock.
     template<typename... Args>
-    V* create(const K& key, Args&&... args) {
-      std::unique_lock lock(m_lock);
+    void createMany(size_t count, const K* objects, const Args&... args) {
+      std::unique_lock lock(m_mutex);
 
-      auto result = m_map.emplace(std::piecewise_construct,
-        std::tuple(key),
-        std::tuple());
+      reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        const uintptr_t key = DispatchKeyTraits<K>::key(objects[i]);
 
-      if (!result.second)
+        if (key && !contains(key))
+          insert(key, DispatchAllocator<std::remove_const_t<V>>::create(objects[i], args...));
+      }
+    }
+
+    void erase(const K& object) {
+      eraseMany(1, &object);
+    }
+
+    void eraseMany(size_t count, const K* objects) {
+      std::vector<V*> values;
+      values.reserve(count);
+
+      {
+        std::unique_lock lock(m_mutex);
+
+        for (size_t i = 0; i < count; i++) {
+          if (V* value = remove(DispatchKeyTraits<K>::key(objects[i])))
+            values.push_back(value);
+        }
+
+        if (values.empty())
+          return;
+
+        m_generation.fetch_add(1, std::memory_order_release);
+      }
+
+      for (V* value : values)
+        DispatchDeleter<V>()(value);
+    }
+
+    // Erases keys without destroying their values, for values that go away
+    // along with whatever owns their memory, eg. a command pool's arena.
+    void releaseMany(size_t count, const K* objects) {
+      std::unique_lock lock(m_mutex);
+
+      bool erased = false;
+      for (size_t i = 0; i < count; i++)
+        erased |= remove(DispatchKeyTraits<K>::key(objects[i])) != nullptr;
+
+      if (erased)
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t generation() const {
+      return m_generation.load(std::memory_order_acquire);
+    }
+  private:
+    static constexpr size_t npos = ~size_t(0);
+
+    static size_t lookup(const Table* table, uintptr_t key) {
+      for (size_t i = table->home(key);; i = (i + 1) & table->mask) {
+        const uintptr_t slotKey = table->slots[i].key.load(std::memory_order_relaxed);
+        if (slotKey == key)
+          return i;
+        if (!slotKey)
+          return npos;
+      }
+    }
+
+    bool contains(uintptr_t key) const {
+      const Table* table = m_table.load(std::memory_order_relaxed);
+      const size_t i = lookup(table, key);
+      return i != npos && table->slots[i].value.load(std::memory_order_relaxed);
+    }
+
+    V* insert(uintptr_t key, V* value) {
+      const Table* table = m_table.load(std::memory_order_relaxed);
+
+      size_t i = table->home(key);
+      for (;; i = (i + 1) & table->mask) {
+        const uintptr_t slotKey = table->slots[i].key.load(std::memory_order_relaxed);
+
+        // Bring a tombstone of the same key back to life.
+        if (slotKey == key) {
+          table->slots[i].value.store(value, std::memory_order_release);
+          m_count++;
+          return value;
+        }
+
+        if (!slotKey)
+          break;
+      }
+
+      // The value has to be there before a reader can match the key.
+      table->slots[i].value.store(value, std::memory_order_relaxed);
+      table->slots[i].key.store(key, std::memory_order_release);
+
+      m_count++;
+      m_used++;
+      return value;
+    }
+
+    V* remove(uintptr_t key) {
+      if (!key)
+        return nullptr;
+
+      const Table* table = m_table.load(std::memory_order_relaxed);
+      const size_t i = lookup(table, key);
+      if (i == npos)
         return nullptr;
 
-      result.first->second = std::make_unique<V>(std::forward<Args>(args)...);
-      return result.first->second.get();
+      // The key stays as a tombstone, readers may be probing past it.
+      V* value = table->slots[i].value.exchange(nullptr, std::memory_order_relaxed);
+      if (value)
+        m_count--;
+      return value;
+    }
+
+    // Makes room for count more keys without going over half full, counting tombstones.
+    // The rebuilt table is at least twice the live entries it needs, so a quarter of it
+    // is free to fill before the next rebuild.
+    void reserve(size_t count) {
+      const Table* table = m_table.load(std::memory_order_relaxed);
+
+      if ((m_used + count) * 2 <= table->mask + 1)
+        return;
+
+      size_t capacity = table->mask + 1;
+      while ((m_count + count) * 4 > capacity)
+        capacity *= 2;
+
+      // Readers that see the new count also see the current table, readers that
+      // see any of the writes below also see the new count and retry.
+      m_rebuilds.store(m_rebuilds.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      Table* newTable = spareTable(capacity);
+
+      for (size_t i = 0; i <= table->mask; i++) {
+        V* value = table->slots[i].value.load(std::memory_order_relaxed);
+        if (!value)
+          continue;
+
+        const uintptr_t key = table->slots[i].key.load(std::memory_order_relaxed);
+        size_t j = newTable->home(key);
+        while (newTable->slots[j].key.load(std::memory_order_relaxed))
+          j = (j + 1) & newTable->mask;
+
+        newTable->slots[j].value.store(value, std::memory_order_relaxed);
+        newTable->slots[j].key.store(key, std::memory_order_relaxed);
+      }
+
+      m_table.store(newTable, std::memory_order_release);
+      m_used = m_count;
+    }
+
+    // An empty table of the given capacity other than the current one.
+    Table* spareTable(size_t capacity) {
+      const Table* current = m_table.load(std::memory_order_relaxed);
+
+      for (const auto& table : m_tables) {
+        if (table.get() == current || table->mask + 1 != capacity)
+          continue;
+
+        for (size_t i = 0; i < capacity; i++) {
+          table->slots[i].key.store(0u, std::memory_order_relaxed);
+          table->slots[i].value.store(nullptr, std::memory_order_relaxed);
+        }
+        return table.get();
+      }
+
+      m_tables.push_back(std::make_unique<Table>(capacity));
+      return m_tables.back().get();
+    }
+
+    std::atomic<const Table*>           m_table = { nullptr };
+    std::atomic<uint64_t>               m_generation = { 0u };
+    std::atomic<uint64_t>               m_rebuilds = { 0u };
+    // Live entries, and live entries plus tombstones of the current table.
+    size_t                              m_count = 0;
+    size_t                              m_used  = 0;
+    std::vector<std::unique_ptr<Table>> m_tables;
+    mutable std::mutex                  m_mutex;
+  };
+
+  // Same interface as ObjectMap, but find() only announces an epoch instead of locking.
+  //
+  // Chained hash table whose nodes never change once published besides their next link.
+  // Writers serialize on a mutex, erased nodes and their values are retired to
+  // Epochs instead of being freed, as are old bucket arrays when the table grows.
+  template <typename K, typename V>
+  class EpochObjectMap {
+    static constexpr size_t InitialBuckets = 64;
+
+    struct Node {
+      K                  key;
+      V*                 value;
+      std::atomic<Node*> next = { nullptr };
+    };
+
+    struct Table {
+      explicit Table(size_t count)
+        : mask(count - 1), buckets(new std::atomic<Node*>[count]) {
+        for (size_t i = 0; i < count; i++)
+          buckets[i].store(nullptr, std::memory_order_relaxed);
+      }
+
+      std::atomic<Node*>& bucket(const K& key) const {
+        return buckets[HashHandle(key) & mask];
+      }
+
+      size_t                                mask;
+      std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+  public:
+
+    EpochObjectMap()
+      : m_table(new Table(InitialBuckets)) {
+    }
+
+    ~EpochObjectMap() {
+      Table* table = m_table.load(std::memory_order_relaxed);
+      for (size_t i = 0; i <= table->mask; i++) {
+        Node* node = table->buckets[i].load(std::memory_order_relaxed);
+        while (node) {
+          Node* next = node->next.load(std::memory_order_relaxed);
+          DispatchDeleter<V>()(node->value);
+          delete node;
+          node = next;
+        }
+      }
+      delete table;
+    }
+
+    EpochObjectMap(const EpochObjectMap&) = delete;
+
+    EpochObjectMap& operator = (const EpochObjectMap&) = delete;
+
+    V *find(const K& key) const {
+      EpochDomain::Guard guard(Epochs);
+
+      const Table* table = m_table.load(std::memory_order_acquire);
+      for (Node* node = table->bucket(key).load(std::memory_order_acquire); node; node = node->next.load(std::memory_order_acquire)) {
+        if (node->key == key)
+          return node->value;
+      }
+      return nullptr;
+    }
+
+    template<typename... Args>
+    V* create(const K& key, Args&&... args) {
+      Table* oldTable;
+      V* value;
+      {
+        std::unique_lock lock(m_mutex);
+
+        if (contains(key))
+          return nullptr;
+
+        oldTable = reserve(m_count + 1);
+        value = insert(key, DispatchAllocator<std::remove_const_t<V>>::create(std::forward<Args>(args)...));
+      }
+
+      retireTable(oldTable);
+      return value;
+    }
+
+    // Creates V(key, args...) for every key under a single lock.
+    template<typename... Args>
+    void createMany(size_t count, const K* keys, const Args&... args) {
+      Table* oldTable;
+      {
+        std::unique_lock lock(m_mutex);
+
+        oldTable = reserve(m_count + count);
+        for (size_t i = 0; i < count; i++) {
+          if (!contains(keys[i]))
+            insert(keys[i], DispatchAllocator<std::remove_const_t<V>>::create(keys[i], args...));
+        }
+      }
+
+      retireTable(oldTable);
     }
 
     void erase(const K& key) {
-      std::unique_lock lock(m_lock);
-      m_map.erase(key);
+      eraseMany(1, &key);
+    }
+
+    void eraseMany(size_t count, const K* keys) {
+      // Retiring may run any deleter that's due, so not under m_mutex.
+      for (Node* node : unlinkMany(count, keys)) {
+        Epochs.retire(node, [](void* object) {
+          Node* node = static_cast<Node*>(object);
+          DispatchDeleter<V>()(node->value);
+          delete node;
+        });
+      }
+    }
+
+    // Erases keys without destroying their values, for values that go away
+    // along with whatever owns their memory, eg. a command pool's arena.
+    // That owner has to be retired after this for readers to be done with them.
+    void releaseMany(size_t count, const K* keys) {
+      for (Node* node : unlinkMany(count, keys))
+        Epochs.retire(node, [](void* object) { delete static_cast<Node*>(object); });
+    }
+
+    uint64_t generation() const {
+      return m_generation.load(std::memory_order_acquire);
+    }
+  private:
+    std::vector<Node*> unlinkMany(size_t count, const K* keys) {
+      std::vector<Node*> nodes;
+      nodes.reserve(count);
+
+      std::unique_lock lock(m_mutex);
+
+      for (size_t i = 0; i < count; i++) {
+        if (Node* node = unlink(keys[i]))
+          nodes.push_back(node);
+      }
+
+      if (!nodes.empty())
+        m_generation.fetch_add(1, std::memory_order_release);
+
+      return nodes;
+    }
+
+    bool contains(const K& key) const {
+      const Table* table = m_table.load(std::memory_order_relaxed);
+      for (Node* node = table->bucket(key).load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed)) {
+        if (node->key == key)
+          return true;
+      }
+      return false;
+    }
+
+    V* insert(const K& key, V* value) {
+      std::atomic<Node*>& bucket = m_table.load(std::memory_order_relaxed)->bucket(key);
+      Node* node = new Node{ key, value };
+      node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      bucket.store(node, std::memory_order_release);
+
+      m_count++;
+      return value;
+    }
+
+    Node* unlink(const K& key) {
+      std::atomic<Node*>* link = &m_table.load(std::memory_order_relaxed)->bucket(key);
+      Node* node = link->load(std::memory_order_relaxed);
+      while (node && node->key != key) {
+        link = &node->next;
+        node = link->load(std::memory_order_relaxed);
+      }
+
+      if (!node)
+        return nullptr;
+
+      // Readers standing on the node can still follow its next link.
+      link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+
+      m_count--;
+      return node;
+    }
+
+    // Keeps at most one entry per bucket on average with count entries.
+    // Nodes are linked into a single chain, so the new table gets copies
+    // and the old table has to be retired along with its nodes, returns it if it was replaced.
+    Table* reserve(size_t count) {
+      Table* table = m_table.load(std::memory_order_relaxed);
+
+      size_t bucketCount = table->mask + 1;
+      while (count > bucketCount)
+        bucketCount *= 2;
+
+      if (bucketCount == table->mask + 1)
+        return nullptr;
+
+      Table* newTable = new Table(bucketCount);
+
+      for (size_t i = 0; i <= table->mask; i++) {
+        for (Node* node = table->buckets[i].load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed)) {
+          std::atomic<Node*>& bucket = newTable->bucket(node->key);
+          Node* copy = new Node{ node->key, node->value };
+          copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+          bucket.store(copy, std::memory_order_relaxed);
+        }
+      }
+
+      m_table.store(newTable, std::memory_order_release);
+      return table;
+    }
+
+    static void retireTable(Table* table) {
+      if (!table)
+        return;
+
+      Epochs.retire(table, [](void* object) {
+        Table* table = static_cast<Table*>(object);
+        for (size_t i = 0; i <= table->mask; i++) {
+          Node* node = table->buckets[i].load(std::memory_order_relaxed);
+          while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+          }
+        }
+        delete table;
+      });
     }
+
+    std::atomic<Table*>   m_table;
+    std::atomic<uint64_t> m_generation = { 0u };
+    size_t                m_count = 0;
+    std::mutex            m_mutex;
+  };
+
+  // Define VKROOTS_CHILD_DISPATCH_BY_KEY before including vkroots.h to stop tracking
+  // queues and command buffers altogether. Their wrappers find the VkDeviceDispatch
+  // through the dispatch key they share with their device, and build the
+  // VkQueueDispatch/VkCommandBufferDispatch on the stack for the duration of the call,
+  // so their UserData does not persist.
+  // Finding devices by key needs LockFreeObjectMap, so this implies VKROOTS_DISPATCH_KEY_LOOKUP.
+#ifdef VKROOTS_CHILD_DISPATCH_BY_KEY
+#ifdef VKROOTS_OBJECTMAP_EPOCH
+#error "VKROOTS_CHILD_DISPATCH_BY_KEY and VKROOTS_OBJECTMAP_EPOCH are mutually exclusive"
+#endif
+#ifndef VKROOTS_DISPATCH_KEY_LOOKUP
+#define VKROOTS_DISPATCH_KEY_LOOKUP
+#endif
+  inline constexpr bool TracksChildDispatches = false;
+#else
+  inline constexpr bool TracksChildDispatches = true;
+#endif
+
+  // Queues get their dispatch from GetDeviceQueue(2), which is hooked for every layer
+  // by default so LookupDispatch(VkQueue) works from any override, eg. a device
+  // function that is handed a queue.
+  // Define VKROOTS_ONLY_TRACK_HOOKED_QUEUES before including vkroots.h to only hook them
+  // when the layer overrides a queue function, LookupDispatch(VkQueue) is null otherwise.
+#ifdef VKROOTS_ONLY_TRACK_HOOKED_QUEUES
+  inline constexpr bool TracksUnhookedQueues = false;
+#else
+  inline constexpr bool TracksUnhookedQueues = true;
+#endif
+
+  // Define VKROOTS_DEVICE_STATE and/or VKROOTS_COMMAND_BUFFER_STATE to a type before
+  // including vkroots.h to keep one of them inline in every VkDeviceDispatch or
+  // VkCommandBufferDispatch, as its State member.
+  // It is default constructed and destroyed along with the dispatch, so unlike
+  // UserData there is no allocation, and no typeid check to get at it.
+#ifdef VKROOTS_DEVICE_STATE
+  using DeviceState = VKROOTS_DEVICE_STATE;
+#else
+  struct DeviceState {};
+#endif
+
+#ifdef VKROOTS_COMMAND_BUFFER_STATE
+#ifdef VKROOTS_CHILD_DISPATCH_BY_KEY
+#error "VKROOTS_COMMAND_BUFFER_STATE and VKROOTS_CHILD_DISPATCH_BY_KEY are mutually exclusive"
+#endif
+  using CommandBufferState = VKROOTS_COMMAND_BUFFER_STATE;
+#else
+  struct CommandBufferState {};
+#endif
+
+  // Queue or command buffer dispatch built on the fly for VKROOTS_CHILD_DISPATCH_BY_KEY.
+  template <typename Dispatch>
+  class ChildDispatch {
+  public:
+    template <typename Handle>
+    ChildDispatch(Handle handle, const VkDeviceDispatch* pDeviceDispatch)
+      : m_dispatch(handle, pDeviceDispatch) {
+    }
+
+    ChildDispatch(const ChildDispatch&) = delete;
+
+    ChildDispatch& operator = (const ChildDispatch&) = delete;
+
+    const Dispatch& operator * () const { return m_dispatch; }
+    const Dispatch* operator -> () const { return &m_dispatch; }
   private:
-    std::unordered_map<K, std::unique_ptr<V>> m_map;
-    mutable RwLock m_lock;
+    Dispatch m_dispatch;
   };
 
   namespace tables {
 
+    // Define VKROOTS_DISPATCH_KEY_LOOKUP before including vkroots.h to have
+    // LookupDispatch go through LockFreeObjectMap instead of ObjectMap,
+    // or VKROOTS_OBJECTMAP_EPOCH to have it go through EpochObjectMap.
+#if defined(VKROOTS_DISPATCH_KEY_LOOKUP) && defined(VKROOTS_OBJECTMAP_EPOCH)
+#error "VKROOTS_DISPATCH_KEY_LOOKUP and VKROOTS_OBJECTMAP_EPOCH are mutually exclusive"
+#elif defined(VKROOTS_DISPATCH_KEY_LOOKUP)
+    template <typename K, typename V>
+    using DispatchMap = LockFreeObjectMap<K, V>;
+#elif defined(VKROOTS_OBJECTMAP_EPOCH)
+    template <typename K, typename V>
+    using DispatchMap = EpochObjectMap<K, V>;
+#else
+    template <typename K, typename V>
+    using DispatchMap = ObjectMap<K, V>;
+#endif
+
     // All our dispatchables...
-    inline ObjectMap<VkInstance,               const VkInstanceDispatch>               InstanceDispatches;
-    inline ObjectMap<VkPhysicalDevice,         const VkPhysicalDeviceDispatch>         PhysicalDeviceDispatches;
-    inline ObjectMap<VkDevice,                 const VkDeviceDispatch>                 DeviceDispatches;
-    inline ObjectMap<VkQueue,                  const VkQueueDispatch>                  QueueDispatches;
-    inline ObjectMap<VkCommandBuffer,          const VkCommandBufferDispatch>          CommandBufferDispatches;
-    inline ObjectMap<VkExternalComputeQueueNV, const VkExternalComputeQueueNVDispatch> ExternalComputeQueueDispatches;
-
-    static inline void CreateDispatchTable(PFN_vkGetInstanceProcAddr nextInstanceProcAddr, PFN_GetPhysicalDeviceProcAddr nextPhysDevProcAddr, VkInstance instance);
+    inline DispatchMap<VkInstance,               const VkInstanceDispatch>               InstanceDispatches;
+    inline DispatchMap<VkPhysicalDevice,         const VkPhysicalDeviceDispatch>         PhysicalDeviceDispatches;
+    inline DispatchMap<VkDevice,                 const VkDeviceDispatch>                 DeviceDispatches;
+    inline DispatchMap<VkQueue,                  const VkQueueDispatch>                  QueueDispatches;
+    inline DispatchMap<VkCommandBuffer,          const VkCommandBufferDispatch>          CommandBufferDispatches;
+    inline DispatchMap<VkExternalComputeQueueNV, const VkExternalComputeQueueNVDispatch> ExternalComputeQueueDispatches;
+
+    static inline void CreateDispatchTable(const VkInstanceCreateInfo* pCreateInfo, PFN_vkGetInstanceProcAddr nextInstanceProcAddr, PFN_GetPhysicalDeviceProcAddr nextPhysDevProcAddr, VkInstance instance, InstanceTracking tracking = InstanceTracking::Full);
     static inline void CreateDispatchTable(const VkDeviceCreateInfo* pCreateInfo, PFN_vkGetDeviceProcAddr nextProcAddr, VkPhysicalDevice physicalDevice, VkDevice device);
     static inline void DestroyDispatchTable(VkInstance instance);
     static inline void DestroyDispatchTable(VkDevice device);
+    static inline void DestroyCommandPoolTable(VkCommandPool commandPool, const VkDeviceDispatch *pDispatch);
 
     static inline const VkPhysicalDeviceDispatch *AssignDispatchTable(VkPhysicalDevice physDev, const VkInstanceDispatch *pDispatch) { return PhysicalDeviceDispatches.create(physDev, physDev, pDispatch); }
     static inline const VkCommandBufferDispatch *AssignDispatchTable(VkCommandBuffer cmdBuffer, const VkDeviceDispatch *pDispatch) { return CommandBufferDispatches.create(cmdBuffer, cmdBuffer, pDispatch); }
     static inline const VkQueueDispatch *AssignDispatchTable(VkQueue queue, const VkDeviceDispatch *pDispatch) { return QueueDispatches.create(queue, queue, pDispatch); }
     static inline const VkExternalComputeQueueNVDispatch *AssignDispatchTable(VkExternalComputeQueueNV queue, const VkDeviceDispatch *pDispatch) { return ExternalComputeQueueDispatches.create(queue, queue, pDispatch); }
+    static inline void AssignDispatchTable(VkQueue queue, uint32_t familyIndex, uint32_t queueIndex, VkDeviceQueueCreateFlags flags, const VkDeviceDispatch *pDispatch);
+    static inline void AssignDispatchTables(uint32_t count, const VkPhysicalDevice *pPhysDevs, const VkInstanceDispatch *pDispatch);
+    static inline void AssignDispatchTables(uint32_t count, const VkPhysicalDeviceGroupProperties *pGroups, const VkInstanceDispatch *pDispatch);
+    static inline void AssignDispatchTables(uint32_t count, const VkCommandBuffer *pCmdBuffers, VkCommandPool commandPool, const VkDeviceDispatch *pDispatch);
     static inline void UnassignDispatchTable(VkPhysicalDevice physDev) { PhysicalDeviceDispatches.erase(physDev); }
     static inline void UnassignDispatchTable(VkCommandBuffer cmdBuffer) { CommandBufferDispatches.erase(cmdBuffer); }
     static inline void UnassignDispatchTable(VkQueue queue) { QueueDispatches.erase(queue); }
     static inline void UnassignDispatchTable(VkExternalComputeQueueNV queue) { ExternalComputeQueueDispatches.erase(queue); }
+    static inline void UnassignDispatchTables(uint32_t count, const VkCommandBuffer *pCmdBuffers) { if constexpr (TracksChildDispatches) CommandBufferDispatches.eraseMany(count, pCmdBuffers); }
+    // For command buffers whose dispatches are destroyed along with their pool's arena or device.
+    static inline void ReleaseDispatchTables(uint32_t count, const VkCommandBuffer *pCmdBuffers) { if constexpr (TracksChildDispatches) CommandBufferDispatches.releaseMany(count, pCmdBuffers); }
+  }
+
+#ifndef VKROOTS_LOOKUP_CACHE_SIZE
+#define VKROOTS_LOOKUP_CACHE_SIZE 4
+#endif
+
+  struct LookupCacheStats {
+    std::atomic<uint64_t> hits   = { 0u };
+    std::atomic<uint64_t> misses = { 0u };
+
+    double hitRate() const {
+      const uint64_t h = hits.load(std::memory_order_relaxed);
+      const uint64_t m = misses.load(std::memory_order_relaxed);
+      return h + m ? double(h) / double(h + m) : 0.0;
+    }
+  };
+
+  // Only counted with VKROOTS_LOOKUP_CACHE_STATS defined, every thread bumping
+  // the same two atomics would cost more than the cache saves.
+  inline LookupCacheStats LookupCacheCounters;
+
+  // Define VKROOTS_LOOKUP_CACHE before including vkroots.h to have each thread
+  // remember its last few lookups per table, recording threads tend to hammer
+  // the same command buffer.
+  // Any erase from the table, ie. UnassignDispatchTable from FreeCommandBuffers,
+  // bumps its generation and throws away every thread's cached entries for it,
+  // so a freed and recycled handle can never hit a stale dispatch.
+  template <typename Map, typename K>
+  static inline auto FindDispatch(const Map& map, K object) {
+#ifdef VKROOTS_LOOKUP_CACHE
+    using V = decltype(map.find(object));
+
+    struct Cache {
+      uint64_t generation = ~uint64_t(0);
+      uint32_t next = 0;
+      K        keys[VKROOTS_LOOKUP_CACHE_SIZE] = {};
+      V        values[VKROOTS_LOOKUP_CACHE_SIZE] = {};
+    };
+    static thread_local Cache cache;
+
+    // Must be read before the lookup, so that an erase racing
+    // with us leaves the entry we add behind already stale.
+    const uint64_t generation = map.generation();
+    if (cache.generation != generation) {
+      cache = Cache{};
+      cache.generation = generation;
+    }
+
+    for (uint32_t i = 0; i < VKROOTS_LOOKUP_CACHE_SIZE; i++) {
+      if (cache.keys[i] == object && cache.values[i]) {
+#ifdef VKROOTS_LOOKUP_CACHE_STATS
+        LookupCacheCounters.hits.fetch_add(1, std::memory_order_relaxed);
+#endif
+        return cache.values[i];
+      }
+    }
+
+#ifdef VKROOTS_LOOKUP_CACHE_STATS
+    LookupCacheCounters.misses.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+    V value = map.find(object);
+    if (value) {
+      cache.keys[cache.next]   = object;
+      cache.values[cache.next] = value;
+      cache.next = (cache.next + 1) % VKROOTS_LOOKUP_CACHE_SIZE;
+    }
+    return value;
+#else
+    return map.find(object);
+#endif
   }
 
-  static inline const VkInstanceDispatch*               LookupDispatch        (VkInstance instance)                             { return tables::InstanceDispatches.find(instance); }
-  static inline const VkPhysicalDeviceDispatch*         LookupDispatch        (VkPhysicalDevice physicalDevice)                 { return tables::PhysicalDeviceDispatches.find(physicalDevice); }
-  static inline const VkDeviceDispatch*                 LookupDispatch        (VkDevice device)                                 { return tables::DeviceDispatches.find(device); }
-  static inline const VkQueueDispatch*                  LookupDispatch        (VkQueue device)                                  { return tables::QueueDispatches.find(device); }
-  static inline const VkCommandBufferDispatch*          LookupDispatch        (VkCommandBuffer cmdBuffer)                       { return tables::CommandBufferDispatches.find(cmdBuffer); }
-  static inline const VkExternalComputeQueueNVDispatch* LookupDispatch        (VkExternalComputeQueueNV externalComputeQueueNV) { return tables::ExternalComputeQueueDispatches.find(externalComputeQueueNV); }
+  static inline const VkInstanceDispatch*               LookupDispatch        (VkInstance instance)                             { return FindDispatch(tables::InstanceDispatches, instance); }
+  static inline const VkPhysicalDeviceDispatch*         LookupDispatch        (VkPhysicalDevice physicalDevice)                 { return FindDispatch(tables::PhysicalDeviceDispatches, physicalDevice); }
+  static inline const VkDeviceDispatch*                 LookupDispatch        (VkDevice device)                                 { return FindDispatch(tables::DeviceDispatches, device); }
+#ifndef VKROOTS_CHILD_DISPATCH_BY_KEY
+  static inline const VkQueueDispatch*                  LookupDispatch        (VkQueue device)                                  { return FindDispatch(tables::QueueDispatches, device); }
+  static inline const VkCommandBufferDispatch*          LookupDispatch        (VkCommandBuffer cmdBuffer)                       { return FindDispatch(tables::CommandBufferDispatches, cmdBuffer); }
+#endif
+  static inline const VkExternalComputeQueueNVDispatch* LookupDispatch        (VkExternalComputeQueueNV externalComputeQueueNV) { return FindDispatch(tables::ExternalComputeQueueDispatches, externalComputeQueueNV); }
+
+  // What the generated queue and command buffer wrappers hand to the overrides,
+  // dereferences to the dispatch either way.
+#ifdef VKROOTS_CHILD_DISPATCH_BY_KEY
+  static inline ChildDispatch<VkQueueDispatch>          ResolveDispatch       (VkQueue queue);
+  static inline ChildDispatch<VkCommandBufferDispatch>  ResolveDispatch       (VkCommandBuffer cmdBuffer);
+#else
+  static inline const VkQueueDispatch*                  ResolveDispatch       (VkQueue queue)                                   { return LookupDispatch(queue); }
+  static inline const VkCommandBufferDispatch*          ResolveDispatch       (VkCommandBuffer cmdBuffer)                       { return LookupDispatch(cmdBuffer); }
+#endif
 
   struct VkInstanceProcAddrFuncs {
     PFN_vkGetInstanceProcAddr NextGetInstanceProcAddr;
@@ -1,6 +1,7 @@
 namespace vkroots {
 
-  static VkResult implicit_wrap_CreateInstance(
+  template <InstanceTracking Tracking>
+  static VKROOTS_COLD VkResult implicit_wrap_CreateInstance(
     const VkInstanceCreateInfo*  pCreateInfo,
     const VkAllocationCallbacks* pAllocator,
           VkInstance*            pInstance) {
@@ -11,7 +12,7 @@ namespace vkroots {
     PFN_vkCreateInstance createInstanceProc = (PFN_vkCreateInstance) instanceProcAddrFuncs.NextGetInstanceProcAddr(nullptr, "vkCreateInstance");
     VkResult ret = createInstanceProc(pCreateInfo, pAllocator, pInstance);
     if (ret == VK_SUCCESS)
-      tables::CreateDispatchTable(instanceProcAddrFuncs.NextGetInstanceProcAddr, instanceProcAddrFuncs.NextGetPhysicalDeviceProcAddr, *pInstance);
+      tables::CreateDispatchTable(pCreateInfo, instanceProcAddrFuncs.NextGetInstanceProcAddr, instanceProcAddrFuncs.NextGetPhysicalDeviceProcAddr, *pInstance, Tracking);
     return ret;
   }
 
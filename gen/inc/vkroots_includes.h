@@ -8,6 +8,7 @@
 #include <vulkan/vulkan.h>
 
 #include <cstring>
+#include <cstddef>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
@@ -19,13 +20,54 @@
 #include <optional>
 #include <string_view>
 #include <array>
+#include <bitset>
 #include <functional>
 #include <shared_mutex>
+#include <thread>
 #include <atomic>
+#include <chrono>
 #include <ranges>
 #include <format>
 #include <iostream>
 #include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VKROOTS_FLATMAP_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VKROOTS_FLATMAP_NEON
+#endif
+
+#ifdef VKROOTS_TRACING
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define VKROOTS_TRACE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define VKROOTS_TRACE_RDTSC
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define VKROOTS_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define VKROOTS_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// Recording and submission paths vs. creation, destruction and lookup paths,
+// GCC and Clang place them in .text.hot and .text.unlikely.
+#if defined(__GNUC__)
+#define VKROOTS_HOT  __attribute__((hot))
+#define VKROOTS_COLD __attribute__((cold))
+#else
+#define VKROOTS_HOT
+#define VKROOTS_COLD
+#endif
 
 #define VKROOTS_VERSION_MAJOR 0
 #define VKROOTS_VERSION_MINOR 1
@@ -0,0 +1,194 @@
+  // Which part of an intercepted call a measurement covers.
+  enum class CallKind : uint32_t {
+    // The generated wrap_ function, ie. the override including the next layer calls it makes.
+    Override,
+    // A dispatch table's call into the next layer.
+    Next,
+    Count,
+  };
+
+  // Latencies are counted in power of two buckets of nanoseconds, bucket i
+  // holds the calls that took [2^i, 2^(i+1)) ns, the last one anything longer.
+  inline constexpr uint32_t LatencyBuckets = 32;
+
+  struct CallStats {
+    uint64_t Count = 0;
+    uint64_t TotalNs = 0;
+    uint64_t Histogram[LatencyBuckets] = {};
+  };
+
+  struct FunctionStats {
+    Function Id;
+    const char* Name;
+    CallStats Calls[uint32_t(CallKind::Count)];
+  };
+
+  // Define VKROOTS_INSTRUMENTATION before including vkroots.h to count calls and
+  // their latencies in every generated wrap_ function and next layer call.
+  // Each thread only ever writes its own counters, InstrumentationSnapshot()
+  // adds them all up when asked.
+  // Without it the VKROOTS_COUNT_CALL and VKROOTS_INSTRUMENT_NEXT hooks expand to nothing.
+#ifdef VKROOTS_INSTRUMENTATION
+  class InstrumentationCounters {
+  public:
+    static void record(Function id, CallKind kind, uint64_t ns) {
+      Counter& counter = local().block(id).Calls[uint32_t(kind)];
+      uint32_t bucket = std::min<uint32_t>(ns ? uint32_t(std::bit_width(ns)) - 1 : 0, LatencyBuckets - 1);
+      // Only this thread writes these, so a load and a store do instead of an atomic add.
+      // They're atomics at all so snapshot() can read them from other threads while they change.
+      bump(counter.Count, 1);
+      bump(counter.TotalNs, ns);
+      bump(counter.Histogram[bucket], 1);
+    }
+
+    static std::vector<FunctionStats> snapshot() {
+      std::vector<FunctionStats> stats(uint32_t(Function::Count));
+      for (uint32_t i = 0; i < uint32_t(Function::Count); i++) {
+        stats[i].Id = Function(i);
+        stats[i].Name = FunctionNames[i];
+      }
+
+      {
+        std::unique_lock lock(s_mutex);
+        for (const Thread* thread : s_threads)
+          thread->addTo(stats);
+        retired().addTo(stats);
+      }
+
+      std::erase_if(stats, [](const FunctionStats& function) {
+        return std::ranges::all_of(function.Calls, [](const CallStats& calls) { return calls.Count == 0; });
+      });
+      return stats;
+    }
+
+  private:
+    struct Counter {
+      std::atomic<uint64_t> Count = 0;
+      std::atomic<uint64_t> TotalNs = 0;
+      std::atomic<uint64_t> Histogram[LatencyBuckets] = {};
+    };
+
+    struct Block {
+      Counter Calls[uint32_t(CallKind::Count)];
+    };
+
+    static void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+      value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // A thread's counters, blocks are only allocated for the functions it calls.
+    class Thread {
+    public:
+      ~Thread() {
+        for (std::atomic<Block*>& block : m_blocks)
+          delete block.load(std::memory_order_relaxed);
+      }
+
+      Block& block(Function id) {
+        std::atomic<Block*>& slot = m_blocks[uint32_t(id)];
+        Block* block = slot.load(std::memory_order_relaxed);
+        if (!block) [[unlikely]] {
+          block = new Block();
+          slot.store(block, std::memory_order_release);
+        }
+        return *block;
+      }
+
+      void addTo(std::vector<FunctionStats>& stats) const {
+        for (uint32_t i = 0; i < uint32_t(Function::Count); i++) {
+          const Block* block = m_blocks[i].load(std::memory_order_acquire);
+          if (!block)
+            continue;
+          for (uint32_t kind = 0; kind < uint32_t(CallKind::Count); kind++) {
+            const Counter& counter = block->Calls[kind];
+            CallStats& calls = stats[i].Calls[kind];
+            calls.Count += counter.Count.load(std::memory_order_relaxed);
+            calls.TotalNs += counter.TotalNs.load(std::memory_order_relaxed);
+            for (uint32_t bucket = 0; bucket < LatencyBuckets; bucket++)
+              calls.Histogram[bucket] += counter.Histogram[bucket].load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      void mergeInto(Thread& other) const {
+        for (uint32_t i = 0; i < uint32_t(Function::Count); i++) {
+          const Block* block = m_blocks[i].load(std::memory_order_relaxed);
+          if (!block)
+            continue;
+          Block& otherBlock = other.block(Function(i));
+          for (uint32_t kind = 0; kind < uint32_t(CallKind::Count); kind++) {
+            const Counter& counter = block->Calls[kind];
+            Counter& otherCounter = otherBlock.Calls[kind];
+            bump(otherCounter.Count, counter.Count.load(std::memory_order_relaxed));
+            bump(otherCounter.TotalNs, counter.TotalNs.load(std::memory_order_relaxed));
+            for (uint32_t bucket = 0; bucket < LatencyBuckets; bucket++)
+              bump(otherCounter.Histogram[bucket], counter.Histogram[bucket].load(std::memory_order_relaxed));
+          }
+        }
+      }
+
+    private:
+      std::atomic<Block*> m_blocks[uint32_t(Function::Count)] = {};
+    };
+
+    // What threads that have exited counted, guarded by s_mutex.
+    static Thread& retired() {
+      static Thread thread;
+      return thread;
+    }
+
+    // Registers the calling thread's counters on first use, and hands what
+    // they counted over to retired() when the thread exits.
+    static Thread& local() {
+      struct Holder {
+        Holder() {
+          std::unique_lock lock(s_mutex);
+          s_threads.push_back(&thread);
+        }
+
+        ~Holder() {
+          std::unique_lock lock(s_mutex);
+          std::erase(s_threads, &thread);
+          thread.mergeInto(retired());
+        }
+
+        Thread thread;
+      };
+      static thread_local Holder holder;
+      return holder.thread;
+    }
+
+    static inline std::mutex           s_mutex;
+    static inline std::vector<Thread*> s_threads;
+  };
+
+  // Times the rest of the scope it's declared in.
+  class InstrumentationScope {
+  public:
+    InstrumentationScope(Function id, CallKind kind)
+      : m_id(id), m_kind(kind), m_start(std::chrono::steady_clock::now()) {
+    }
+
+    ~InstrumentationScope() {
+      auto elapsed = std::chrono::steady_clock::now() - m_start;
+      InstrumentationCounters::record(m_id, m_kind, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+  private:
+    Function                              m_id;
+    CallKind                              m_kind;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  // Every function that has been called so far, with its calls added up over all threads.
+  static inline std::vector<FunctionStats> InstrumentationSnapshot() {
+    return InstrumentationCounters::snapshot();
+  }
+
+#define VKROOTS_COUNT_CALL(func) ::vkroots::InstrumentationScope vkroots_instrumentation_scope(::vkroots::Function::func, ::vkroots::CallKind::Override)
+#define VKROOTS_INSTRUMENT_NEXT(func) ::vkroots::InstrumentationScope vkroots_instrumentation_scope(::vkroots::Function::func, ::vkroots::CallKind::Next)
+#else
+#define VKROOTS_COUNT_CALL(func)
+#define VKROOTS_INSTRUMENT_NEXT(func)
+#endif
+
@@ -7,6 +7,7 @@ namespace vkroots {
     pVersionStruct->loaderLayerInterfaceVersion = 2;
 
     // Can't optimize away not having instance overrides from the layer, need to track device creation and instance dispatch and stuff.
+    // The instance dispatch only resolves what that needs then, see InstanceTracking.
     pVersionStruct->pfnGetInstanceProcAddr       = std::is_base_of<NoOverrides, InstanceOverrides>::value && std::is_base_of<NoOverrides, DeviceOverrides>::value
                                                      ? nullptr
                                                      : &GetInstanceProcAddr<InstanceOverrides, DeviceOverrides>;
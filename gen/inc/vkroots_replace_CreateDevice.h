@@ -4,11 +4,12 @@
       const VkDeviceCreateInfo*    pCreateInfo,
       const VkAllocationCallbacks* pAllocator,
             VkDevice*              pDevice) const {
+    VKROOTS_INSTRUMENT_NEXT(CreateDevice);
     PFN_vkGetDeviceProcAddr deviceProcAddr;
     VkResult procAddrRes = GetProcAddrs(pCreateInfo, &deviceProcAddr);
     if (procAddrRes != VK_SUCCESS)
       return procAddrRes;
-    VkResult ret = m_CreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+    VkResult ret = m_Procs->m_CreateDevice.get(m_GetInstanceProcAddr, Instance, "vkCreateDevice")(physicalDevice, pCreateInfo, pAllocator, pDevice);
     if (ret == VK_SUCCESS)
       tables::CreateDispatchTable(pCreateInfo, deviceProcAddr, physicalDevice, *pDevice);
     return ret;
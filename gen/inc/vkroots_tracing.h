@@ -0,0 +1,241 @@
+  // Define VKROOTS_TRACING before including vkroots.h to record a begin and an end
+  // event for every call that goes through a generated wrap_ function.
+  //
+  // Each thread writes its events to its own ring, a background thread drains
+  // them into a Chrome trace (JSON array format, which Perfetto's UI opens too)
+  // at $VKROOTS_TRACE_FILE, or vkroots_trace.json in the working directory.
+  // Events are dropped rather than blocking a thread whose ring is full.
+  //
+  // Define VKROOTS_TRACE_RING_SIZE to the number of events a ring holds, a power of two.
+  // A ring takes 24 bytes per event and is only allocated for threads that make calls,
+  // the default of 4096 is 96 KiB each. Raise it if the trace reports dropped events.
+#ifdef VKROOTS_TRACING
+#ifndef VKROOTS_TRACE_RING_SIZE
+#define VKROOTS_TRACE_RING_SIZE 4096
+#endif
+
+  static_assert(std::has_single_bit(uint32_t(VKROOTS_TRACE_RING_SIZE)), "VKROOTS_TRACE_RING_SIZE must be a power of two.");
+
+  // Timestamp counter ticks where there is one, steady clock ticks otherwise.
+  static inline uint64_t TraceTimestamp() {
+#ifdef VKROOTS_TRACE_RDTSC
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  struct TraceEvent {
+    uint64_t    Timestamp;
+    const void* Handle;
+    Function    Id;
+    char        Phase;
+  };
+
+  // Single producer, single consumer.
+  // Only the owning thread pushes and only the flusher pops.
+  class TraceRing {
+  public:
+    static constexpr uint32_t Capacity = VKROOTS_TRACE_RING_SIZE;
+
+    explicit TraceRing(uint32_t threadId)
+      : ThreadId(threadId) {
+    }
+
+    void push(Function id, char phase, const void* handle) {
+      uint64_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) == Capacity) [[unlikely]] {
+        Dropped.store(Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+      }
+      m_events[head & (Capacity - 1)] = TraceEvent{ TraceTimestamp(), handle, id, phase };
+      m_head.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename Func>
+    void drain(Func func) {
+      uint64_t tail = m_tail.load(std::memory_order_relaxed);
+      uint64_t head = m_head.load(std::memory_order_acquire);
+      for (; tail != head; tail++)
+        func(m_events[tail & (Capacity - 1)]);
+      m_tail.store(tail, std::memory_order_release);
+    }
+
+    const uint32_t        ThreadId;
+    std::atomic<uint64_t> Dropped = 0;
+    // How many of those the flusher has put in the trace.
+    uint64_t              ReportedDrops = 0;
+    // Set when the owning thread exits, the ring goes away once it's drained.
+    std::atomic<bool>     Exited  = false;
+
+  private:
+    alignas(64) std::atomic<uint64_t> m_head = 0;
+    alignas(64) std::atomic<uint64_t> m_tail = 0;
+    TraceEvent m_events[Capacity];
+  };
+
+  class Tracer {
+  public:
+    static Tracer& get() {
+      static Tracer tracer;
+      return tracer;
+    }
+
+    // The calling thread's ring, registered with the flusher on first use.
+    static TraceRing& local() {
+      struct Holder {
+        Holder() {
+          Tracer& tracer = Tracer::get();
+          std::unique_lock lock(tracer.m_mutex);
+          ring = std::make_shared<TraceRing>(tracer.m_nextThreadId++);
+          tracer.m_rings.push_back(ring);
+        }
+
+        ~Holder() {
+          ring->Exited.store(true, std::memory_order_release);
+        }
+
+        std::shared_ptr<TraceRing> ring;
+      };
+      static thread_local Holder holder;
+      return *holder.ring;
+    }
+
+  private:
+    Tracer() {
+      const char* path = std::getenv("VKROOTS_TRACE_FILE");
+      m_file = std::fopen(path && *path ? path : "vkroots_trace.json", "w");
+      if (m_file)
+        std::fputs("[\n", m_file);
+      m_startTicks = TraceTimestamp();
+      m_startTime = std::chrono::steady_clock::now();
+      m_flusher = std::thread([this] { flushLoop(); });
+    }
+
+    ~Tracer() {
+      {
+        std::unique_lock lock(m_mutex);
+        m_stop = true;
+      }
+      m_wakeup.notify_all();
+      m_flusher.join();
+
+      flush();
+      if (m_file) {
+        // Chrome copes with the ] missing too, eg. after a crash.
+        std::fputs("\n]\n", m_file);
+        std::fclose(m_file);
+      }
+    }
+
+    // Timestamp ticks per microsecond, measured once so every flush converts them the same.
+    static double calibrate() {
+#ifdef VKROOTS_TRACE_RDTSC
+      const uint64_t startTicks = TraceTimestamp();
+      const auto startTime = std::chrono::steady_clock::now();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      const uint64_t ticks = TraceTimestamp() - startTicks;
+      const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+      return us > 0.0 && ticks ? double(ticks) / us : 1.0;
+#else
+      return 1.0 / std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(1)).count();
+#endif
+    }
+
+    void flushLoop() {
+      // Here rather than in the constructor, so no app thread waits for it.
+      // Nothing is flushed before it's done, the destructor joins this thread first.
+      m_ticksPerUs = calibrate();
+
+      std::unique_lock lock(m_mutex);
+      while (!m_stop) {
+        m_wakeup.wait_for(lock, std::chrono::milliseconds(50));
+        lock.unlock();
+        flush();
+        lock.lock();
+      }
+    }
+
+    void flush() {
+      std::vector<std::shared_ptr<TraceRing>> rings;
+      {
+        std::unique_lock lock(m_mutex);
+        rings = m_rings;
+      }
+
+      for (const std::shared_ptr<TraceRing>& ring : rings) {
+        // Read before draining, anything pushed before it exited is in there then.
+        bool exited = ring->Exited.load(std::memory_order_acquire);
+        ring->drain([&](const TraceEvent& event) {
+          if (!m_file)
+            return;
+          double ts = double(int64_t(event.Timestamp - m_startTicks)) / m_ticksPerUs;
+          std::fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"handle\":\"%p\"}}",
+            m_written++ ? ",\n" : "", FunctionNames[uint32_t(event.Id)], event.Phase, ts, ring->ThreadId, event.Handle);
+        });
+        uint64_t dropped = ring->Dropped.load(std::memory_order_relaxed);
+        if (m_file && dropped != ring->ReportedDrops) {
+          double ts = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_startTime).count();
+          std::fprintf(m_file, "%s{\"name\":\"dropped events\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"count\":%llu}}",
+            m_written++ ? ",\n" : "", ts, ring->ThreadId, (unsigned long long) dropped);
+          ring->ReportedDrops = dropped;
+        }
+        if (exited) {
+          std::unique_lock lock(m_mutex);
+          std::erase(m_rings, ring);
+        }
+      }
+
+      if (m_file)
+        std::fflush(m_file);
+    }
+
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_wakeup;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    uint32_t                                m_nextThreadId = 0;
+    bool                                    m_stop         = false;
+    std::FILE*                              m_file         = nullptr;
+    uint64_t                                m_written      = 0;
+    uint64_t                                m_startTicks   = 0;
+    double                                  m_ticksPerUs   = 1.0;
+    std::chrono::steady_clock::time_point   m_startTime;
+    std::thread                             m_flusher;
+  };
+
+  // Records a begin event now and the matching end event when it goes out of scope.
+  class TraceScope {
+  public:
+    TraceScope(Function id, const void* handle)
+      : m_ring(Tracer::local()), m_id(id), m_handle(handle) {
+      m_ring.push(m_id, 'B', m_handle);
+    }
+
+    ~TraceScope() {
+      m_ring.push(m_id, 'E', m_handle);
+    }
+
+  private:
+    TraceRing&  m_ring;
+    Function    m_id;
+    const void* m_handle;
+  };
+
+#define VKROOTS_TRACE_CALL(func, handle) ::vkroots::TraceScope vkroots_trace_scope(::vkroots::Function::func, handle)
+#else
+#define VKROOTS_TRACE_CALL(func, handle)
+#endif
+
+  // What the generated wrap_ functions do around every intercepted call,
+  // nothing unless VKROOTS_INSTRUMENTATION or VKROOTS_TRACING are defined.
+  // The call site supplies the final semicolon, so with both off it's left with nothing else.
+#if defined(VKROOTS_INSTRUMENTATION) && defined(VKROOTS_TRACING)
+#define VKROOTS_INSTRUMENT_CALL(func, handle) VKROOTS_COUNT_CALL(func); VKROOTS_TRACE_CALL(func, handle)
+#elif defined(VKROOTS_INSTRUMENTATION)
+#define VKROOTS_INSTRUMENT_CALL(func, handle) VKROOTS_COUNT_CALL(func)
+#elif defined(VKROOTS_TRACING)
+#define VKROOTS_INSTRUMENT_CALL(func, handle) VKROOTS_TRACE_CALL(func, handle)
+#else
+#define VKROOTS_INSTRUMENT_CALL(func, handle)
+#endif
+
@@ -326,6 +326,9 @@ class VkFunction(object):
         self.params = params
         self.alias = alias
 
+        # Core version (e.g. VK_VERSION_1_1) that provides this function, if any.
+        self.feature = None
+
         # Required is set while parsing which APIs and types are required
         # and is used by the code generation.
         self.required = False
@@ -1940,6 +1943,8 @@ class VkRegistry(object):
                             continue
                         name = tag.attrib["name"]
                         self._mark_command_required(name)
+                        if self.funcs[name].feature is None:
+                            self.funcs[name].feature = feature_name
                     elif tag.tag == "enum":
                         self._process_require_enum(tag)
                     elif tag.tag == "type":
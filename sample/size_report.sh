@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Builds the sample layer like build.sh does and reports how much of its code
+# ended up hot (.text.hot), cold (.text.unlikely) or in neither.
+# Pass extra flags in CXXFLAGS, eg. a Vulkan SDK include path.
+cd "$(dirname "$0")" || exit 1
+object=$(mktemp --suffix .o) || exit 1
+trap 'rm -f "$object"' EXIT
+
+g++ -std=c++20 -O2 -fvisibility=hidden -fPIC -I.. $CXXFLAGS -c VkLayer_FROG_sample.cpp -o "$object" || exit 1
+
+size -A "$object" | awk '
+  $1 ~ /^\.text\.hot/      { hot  += $2; next }
+  $1 ~ /^\.text\.unlikely/ { cold += $2; next }
+  $1 ~ /^\.text/           { rest += $2 }
+  END {
+    printf "hot:   %8d bytes\n", hot
+    printf "cold:  %8d bytes\n", cold
+    printf "other: %8d bytes\n", rest
+  }'
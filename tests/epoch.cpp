@@ -0,0 +1,108 @@
+#include "vkroots.h"
+
+#include <cstdio>
+
+// Checks EpochDomain copes with deleters retiring more objects,
+// like a device dispatch retiring its command pool arenas,
+// frees in retirement order across threads, and keeps each
+// domain's readers apart.
+
+#define CHECK(cond, ...) \
+  do { if (!(cond)) { std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); std::fprintf(stderr, __VA_ARGS__); std::fprintf(stderr, "\n"); return 1; } } while (0)
+
+namespace {
+
+  vkroots::EpochDomain* Domain = nullptr;
+  std::vector<int>      Deleted;
+  std::mutex            DeletedMutex;
+  std::atomic<bool>     SlowDeleterStarted = { false };
+
+  struct Child {
+    int id;
+  };
+
+  struct Parent {
+    int    id;
+    Child* child;
+  };
+
+  void DeleteChild(void* object) {
+    Child* child = static_cast<Child*>(object);
+    Deleted.push_back(child->id);
+    delete child;
+  }
+
+  void DeleteInt(void* object) {
+    int* value = static_cast<int*>(object);
+    std::unique_lock lock(DeletedMutex);
+    Deleted.push_back(*value);
+    delete value;
+  }
+
+  void DeleteIntSlowly(void* object) {
+    SlowDeleterStarted.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    DeleteInt(object);
+  }
+
+  void DeleteParent(void* object) {
+    Parent* parent = static_cast<Parent*>(object);
+    Deleted.push_back(parent->id);
+    Domain->retire(parent->child, DeleteChild);
+    delete parent;
+  }
+
+}
+
+int main() {
+  {
+    vkroots::EpochDomain domain;
+    Domain = &domain;
+
+    // No readers, so everything is freed right away, children right after their parent.
+    domain.retire(new Parent{ 1, new Child{ 2 } }, DeleteParent);
+    CHECK(Deleted == std::vector<int>({ 1, 2 }), "parent and child not freed right away");
+
+    // With a reader in the way, it's all left to the destructor.
+    Deleted.clear();
+    {
+      vkroots::EpochDomain::Guard guard(domain);
+      domain.retire(new Parent{ 3, new Child{ 4 } }, DeleteParent);
+      domain.retire(new Parent{ 5, new Child{ 6 } }, DeleteParent);
+    }
+    CHECK(Deleted.empty(), "freed %zu objects while a reader could still see them", Deleted.size());
+  }
+  CHECK(Deleted == std::vector<int>({ 3, 4, 5, 6 }), "destructor freed %zu of 4 objects, or out of order", Deleted.size());
+
+  // A reader in one domain doesn't hold up another, and a thread can use both.
+  Deleted.clear();
+  {
+    vkroots::EpochDomain first, second;
+    {
+      vkroots::EpochDomain::Guard guard(first);
+      second.retire(new int(7), DeleteInt);
+      CHECK(Deleted == std::vector<int>({ 7 }), "a reader of another domain held up reclamation");
+
+      vkroots::EpochDomain::Guard secondGuard(second);
+      second.retire(new int(8), DeleteInt);
+      CHECK(Deleted == std::vector<int>({ 7 }), "freed an object while a reader could still see it");
+    }
+    second.retire(new int(9), DeleteInt);
+    CHECK(Deleted == std::vector<int>({ 7, 8, 9 }), "reader kept announcing after its guard");
+  }
+
+  // Whatever one thread retires after another is freed after it, even while
+  // the other thread is still running the earlier deleter.
+  Deleted.clear();
+  {
+    vkroots::EpochDomain domain;
+    std::thread slow([&] { domain.retire(new int(10), DeleteIntSlowly); });
+    while (!SlowDeleterStarted.load())
+      std::this_thread::yield();
+    domain.retire(new int(11), DeleteInt);
+    slow.join();
+  }
+  CHECK(Deleted == std::vector<int>({ 10, 11 }), "objects retired on two threads freed out of order");
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+#include "vkroots.h"
+
+#include <cstdio>
+
+// Checks FlatMap stays between half and 14/16 full as it grows and shrinks.
+
+#define CHECK(cond, ...) \
+  do { if (!(cond)) { std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); std::fprintf(stderr, __VA_ARGS__); std::fprintf(stderr, "\n"); return 1; } } while (0)
+
+namespace {
+
+  constexpr size_t GroupSize = 16;
+
+  VkImage MakeImage(uint64_t index) {
+    return reinterpret_cast<VkImage>(uintptr_t((index + 1) * 64u));
+  }
+
+}
+
+int main() {
+  vkroots::FlatMap<VkImage, uint64_t> map;
+  CHECK(map.capacity() == 0, "empty map has capacity %zu", map.capacity());
+
+  constexpr uint64_t Count = 20000;
+  for (uint64_t i = 0; i < Count; i++) {
+    CHECK(map.emplace(MakeImage(i), i).second, "image %llu inserted twice", (unsigned long long)i);
+
+    const size_t size = map.size(), capacity = map.capacity();
+    CHECK(size * GroupSize <= capacity * 14, "%zu entries in %zu slots, over 14/16 full", size, capacity);
+    // Only grows when the entries would not fit in half the slots.
+    CHECK(capacity == GroupSize || size * GroupSize * 2 > capacity * 14, "%zu entries in %zu slots, grew too early", size, capacity);
+  }
+
+  for (uint64_t i = 0; i < Count; i++) {
+    const uint64_t* value = map.find(MakeImage(i));
+    CHECK(value && *value == i, "image %llu missing after growth", (unsigned long long)i);
+  }
+
+  // Erasing keeps every other entry reachable.
+  for (uint64_t i = 0; i < Count; i += 2)
+    CHECK(map.erase(MakeImage(i)), "image %llu not erased", (unsigned long long)i);
+  for (uint64_t i = 0; i < Count; i++)
+    CHECK(!map.find(MakeImage(i)) == !(i & 1), "image %llu %s after erasing", (unsigned long long)i, (i & 1) ? "missing" : "still there");
+
+  // Reserving up front allocates the smallest table that fits and doesn't grow again.
+  vkroots::FlatMap<VkImage, uint64_t> reserved;
+  reserved.reserve(1000);
+  CHECK(reserved.capacity() == 128 * GroupSize, "reserving 1000 entries gave %zu slots", reserved.capacity());
+  for (uint64_t i = 0; i < 1000; i++)
+    reserved.emplace(MakeImage(i), i);
+  CHECK(reserved.capacity() == 128 * GroupSize, "1000 entries grew a reserved map to %zu slots", reserved.capacity());
+
+  return 0;
+}